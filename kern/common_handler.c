@@ -7,7 +7,9 @@
  */
 
 #include <syscall_int.h>
+#include <syscall_ext.h>
 #include <common_wrapper.h>
+#include <sysenter.h>
 #include <install_desc.h>
 #include <reporter.h>
 
@@ -263,6 +265,186 @@ void swexn_install(void *idt_base_p) {
                     trap_gate, 3);
 }
 
+/** @brief install the set_mem_limit syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void set_mem_limit_install(void *idt_base_p) {
+    install_desc(idt_base_p, SET_MEM_LIMIT_INT, set_mem_limit_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the get_mem_usage syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void get_mem_usage_install(void *idt_base_p) {
+    install_desc(idt_base_p, GET_MEM_USAGE_INT, get_mem_usage_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the stack_region syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void stack_region_install(void *idt_base_p) {
+    install_desc(idt_base_p, STACK_REGION_INT, stack_region_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the spawn syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void spawn_install(void *idt_base_p) {
+    install_desc(idt_base_p, SPAWN_INT, spawn_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the template_freeze syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void template_freeze_install(void *idt_base_p) {
+    install_desc(idt_base_p, TEMPLATE_FREEZE_INT, template_freeze_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the template_spawn syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void template_spawn_install(void *idt_base_p) {
+    install_desc(idt_base_p, TEMPLATE_SPAWN_INT, template_spawn_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the template_drop syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void template_drop_install(void *idt_base_p) {
+    install_desc(idt_base_p, TEMPLATE_DROP_INT, template_drop_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the ring_setup syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void ring_setup_install(void *idt_base_p) {
+    install_desc(idt_base_p, RING_SETUP_INT, ring_setup_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the ring_enter syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void ring_enter_install(void *idt_base_p) {
+    install_desc(idt_base_p, RING_ENTER_INT, ring_enter_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the futex_wait syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void futex_wait_install(void *idt_base_p) {
+    install_desc(idt_base_p, FUTEX_WAIT_INT, futex_wait_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the futex_wake syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void futex_wake_install(void *idt_base_p) {
+    install_desc(idt_base_p, FUTEX_WAKE_INT, futex_wake_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the syscall_stats syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void syscall_stats_install(void *idt_base_p) {
+    install_desc(idt_base_p, SYSCALL_STATS_INT, syscall_stats_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the console_mode syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void console_mode_install(void *idt_base_p) {
+    install_desc(idt_base_p, CONSOLE_MODE_INT, console_mode_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the set_vterm syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void set_vterm_install(void *idt_base_p) {
+    install_desc(idt_base_p, SET_VTERM_INT, set_vterm_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the blit_cells syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void blit_cells_install(void *idt_base_p) {
+    install_desc(idt_base_p, BLIT_CELLS_INT, blit_cells_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the console_map syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void console_map_install(void *idt_base_p) {
+    install_desc(idt_base_p, CONSOLE_MAP_INT, console_map_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the poll syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void poll_install(void *idt_base_p) {
+    install_desc(idt_base_p, POLL_INT, poll_wrapper, 
+                    trap_gate, 3);
+}
+
+/** @brief install the print_flush syscall
+ *  
+ *  @param idt_base_p the idt base pointer
+ *  @return Void
+ */
+void print_flush_install(void *idt_base_p) {
+    install_desc(idt_base_p, PRINT_FLUSH_INT, print_flush_wrapper, 
+                    trap_gate, 3);
+}
+
 void syscall_install(void *idt_base_p) {
     report_progress(tag, "installing syscall to idt");
 
@@ -292,6 +474,27 @@ void syscall_install(void *idt_base_p) {
     vanish_install(idt_base_p);
     readfile_install(idt_base_p);
     swexn_install(idt_base_p);
+    set_mem_limit_install(idt_base_p);
+    get_mem_usage_install(idt_base_p);
+    stack_region_install(idt_base_p);
+    spawn_install(idt_base_p);
+    template_freeze_install(idt_base_p);
+    template_spawn_install(idt_base_p);
+    template_drop_install(idt_base_p);
+    ring_setup_install(idt_base_p);
+    ring_enter_install(idt_base_p);
+    futex_wait_install(idt_base_p);
+    futex_wake_install(idt_base_p);
+    syscall_stats_install(idt_base_p);
+    console_mode_install(idt_base_p);
+    set_vterm_install(idt_base_p);
+    blit_cells_install(idt_base_p);
+    console_map_install(idt_base_p);
+    poll_install(idt_base_p);
+    print_flush_install(idt_base_p);
+
+    /* the same syscalls through SYSENTER */
+    sysenter_init();
 
     report_progress(tag, "installing syscall done!");
 }
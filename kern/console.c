@@ -2,6 +2,28 @@
  *
  *  @brief Write characters to the console.
  *
+ *  There are NVTERMS virtual terminals, each with its own screen, cursor,
+ *  color and input line. A process prints to the terminal in its pcb, the
+ *  keyboard types into the foreground one, and only the foreground one is
+ *  on the screen.
+ *
+ *  Everything is drawn into, and read back from, the cells of a terminal
+ *  in RAM. console_flush copies the rows of the foreground terminal that
+ *  changed to video memory and updates the CRTC: at the end of every call
+ *  in CONSOLE_MODE_SYNC, or on the next timer tick in
+ *  CONSOLE_MODE_DEFERRED.
+ *
+ *  Output goes through a small ANSI/VT100 parser: ESC [ row ; col H (or f)
+ *  and ESC [ n A/B/C/D move the cursor, ESC [ n J and ESC [ n K erase the
+ *  screen and the line, ESC [ ... m sets colors (0, 1, 5, 22, 25, 30-37,
+ *  39, 40-47, 49, 90-97), ESC [ s and ESC [ u save and restore the cursor
+ *  and ESC [ ? 25 h/l show and hide it. Its state is kept in the terminal,
+ *  so a sequence may be split across prints.
+ *
+ *  What the foreground terminal prints is also sent to the serial port,
+ *  escape sequences and all, in SERIAL_CONSOLE_MIRROR, or only there in
+ *  SERIAL_CONSOLE_REDIRECT.
+ *
  *  @author HingOn Miu (hmiu)
  */
 
@@ -11,10 +33,16 @@
 #include <simics.h>
 #include <limits.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <cond.h>
 #include <malloc.h>
 #include <syscall.h>
+#include <syscall_ext.h>
 #include <reporter.h>
+#include <loader.h>
+#include <if_flag.h>
+#include <serial_driver.h>
 
 /* a random number to make the index goes out of the console */
 #define RAN_NUM 0xbeef
@@ -26,39 +54,80 @@
 #define HIDE_OFFSET_LSB ((CONSOLE_SIZE + RAN_NUM) & UCHAR_MAX)
 /* the default color on the console */
 #define DEFAULT_COLOR ((!BLINK) | FGND_WHITE | BGND_BLACK)
-
-circ_buf_t cons_buf;
-
-queue cons_cond_queue;
+/* the rows of the 32 KB text mode video memory the console slides over */
+#define VIDEO_MEM_ROWS ((0x8000 / 2) / CONSOLE_WIDTH)
+/* the CRTC registers of the first cell on the screen */
+#define CRTC_START_MSB_IDX 0x0c
+#define CRTC_START_LSB_IDX 0x0d
+/* the cell of a terminal location, the rows of a terminal are a ring */
+#define CONSOLE_CELL(vt, row, col) \
+    ((vt)->cells + (((vt)->first + (row)) % CONSOLE_HEIGHT) * \
+     CONSOLE_WIDTH + (col))
+/* the video memory cell of a console location */
+#define VIDEO_CELL(row, col) \
+    ((uint16_t *)CONSOLE_MEM_BASE + console_top + \
+     (row) * CONSOLE_WIDTH + (col))
+/* the dirty bit of a console row */
+#define ROW_BIT(row) ((uint32_t)1 << (row))
+/* all the rows dirty */
+#define ALL_ROWS (ROW_BIT(CONSOLE_HEIGHT) - 1)
+/* the escape character, starts an ANSI escape sequence */
+#define ESC '\033'
+/* where a terminal is in an escape sequence: none, right after ESC, or
+ * reading the parameters after ESC [
+ */
+#define ESC_NONE 0
+#define ESC_START 1
+#define ESC_CSI 2
+/* the largest escape sequence parameter kept */
+#define ESC_PARAM_MAX 9999
+/* the foreground, its bright bit and the background of a color */
+#define COLOR_FGND 0x0f
+#define COLOR_BRIGHT 0x08
+#define COLOR_BGND 0x70
+/* a character and its color as one video memory cell */
+#define CELL(ch, color) \
+    ((uint16_t)((((color) & UCHAR_MAX) << CHAR_BIT) | ((ch) & UCHAR_MAX)))
 
 mutex_t outb_mp;
 
 static char *tag = "console";
 
-/** @brief Records whether the user decides to hide the cursor.
+/** @brief The VGA color of each ANSI color (black, red, green, yellow,
+ *         blue, magenta, cyan, white).
  **/
-int cursor_is_visible = 1;
-/** @brief Records cursor's actual console row location.
+static const int ansi_colors[8] = { 0, 4, 2, 6, 1, 5, 3, 7 };
+/** @brief The virtual terminals, and their cells, a page each so they can
+ *         be mapped into a process.
  **/
-int cursor_row = 0;
-/** @brief Records cursor's actual console col location.
+static vterm_t vterms[NVTERMS];
+static uint16_t vt_pages[NVTERMS][PAGE_SIZE / sizeof(uint16_t)]
+    __attribute__((aligned(PAGE_SIZE)));
+/** @brief The terminal on the screen.
  **/
-int cursor_col = 0;
-/** @brief Records the default color for writing characters to the console.
+static vterm_t *vt_fg = &vterms[0];
+/** @brief The cursor offset last written to the CRTC, -1 if unknown. Output
+ *         only moves the cursor of the terminal, the CRTC is written once
+ *         per flush, and not at all if the offset is the same.
  **/
-int term_color = (!BLINK) | FGND_WHITE | BGND_BLACK;
-
-/** @brief The most significant bits of cursor's actual console location.
- *
- *  @return 8 bits msb of cursor's location.
+static int cursor_hw_offset = -1;
+/** @brief The video memory cell the screen starts at. Scrolling slides
+ *         this window down, and it goes back to the start of video memory
+ *         only when it reaches the end.
  **/
-uint8_t get_offset_msb();
-
-/** @brief The least significant bits of cursor's actual console location.
- *
- *  @return 8 bits lsb of cursor's location.
+static int console_top = 0;
+/** @brief The start address last written to the CRTC, -1 if unknown.
  **/
-uint8_t get_offset_lsb();
+static int console_hw_top = -1;
+/** @brief When the console gets flushed, CONSOLE_MODE_SYNC or
+ *         CONSOLE_MODE_DEFERRED.
+ **/
+static int console_mode = CONSOLE_MODE_SYNC;
+/** @brief The terminal Alt+Fn asked for, -1 if none. The keyboard handler
+ *         can't take outb_mp, so console_tick or the next console_leave
+ *         brings it to the screen.
+ **/
+static volatile int vt_switch_pending = -1;
 
 /** @brief Get the color of the location on console.
  *
@@ -69,145 +138,826 @@ uint8_t get_offset_lsb();
  **/
 char get_color(int row, int col);
 
-/** @brief Scroll up the console screen if needed by shifting every character
- *         up by one row.
+/** @brief Scroll up a terminal by one row.
+ *
+ *   @param vt The terminal.
  *
  *   @return Void.
  **/
-void console_scroll_up();
+static void console_scroll_up(vterm_t *vt);
 
-/** @brief Find the last non-space character at the specific row on console.
+/** @brief Find the last non-space character at the specific row of a
+ *         terminal.
  *
+ *   @param vt The terminal.
  *   @param row The row index on console
  *
  *   @return The column index on the console.
  **/
-int find_last_char(int row);
+static int find_last_char(vterm_t *vt, int row);
 
-
-/** @brief Set the cursor location at row and col index.
+/** @brief Clear a terminal and move its cursor to the top left corner.
  *
- *   @param row The row index on console
- *   @param col The col index on console
+ *   @param vt The terminal.
  *
- *   @return 0 if successful, -1 if fail.
+ *   @return Void.
  **/
-int set_cursor(int row, int col);
+static void vt_clear(vterm_t *vt);
 
 
 int cons_init() {
+    vterm_t *vt;
+    int i;
 
-    if (cb_init(&cons_buf, PAGE_SIZE) != 0) {
-        report_error(tag, "cons_init: fail to initialize circular buffer");
+    if (mutex_init(&outb_mp) != 0) {
+        report_error(tag, "cons_init: fail to initialize mutex");
         return -1;
     }
 
+    for (i = 0; i < NVTERMS; i++) {
+        vt = &vterms[i];
+        vt->cells = vt_pages[i];
+
+        if (ldisc_init(&(vt->in)) != 0) {
+            report_error(tag, "cons_init: fail to initialize line discipline");
+            return -1;
+        }
+
+        if (mutex_init(&(vt->print_mp)) != 0) {
+            report_error(tag, "cons_init: fail to initialize print mutex");
+            return -1;
+        }
+
+        vt->cursor_is_visible = 1;
+        vt->term_color = DEFAULT_COLOR;
+
+        vt_clear(vt);
+    }
+
+    return 0;
+}
+
+vterm_t *vt_running()
+{
+    if (running_ktcb == NULL || running_ktcb->tcb == NULL) {
+        return &vterms[0];
+    }
+
+    return &vterms[running_ktcb->tcb->pcb->vt];
+}
+
+vterm_t *vt_foreground()
+{
+    return vt_fg;
+}
+
+vterm_t *vt_get(int idx)
+{
+    if (idx < 0 || idx >= NVTERMS) {
+        return NULL;
+    }
+
+    return &vterms[idx];
+}
+
+
+/** @brief Bring video memory and the CRTC up to date with the foreground
+ *         terminal: slide the window by the rows scrolled, copy the dirty
+ *         rows, then write the start address and the cursor if they
+ *         changed. The caller holds outb_mp, or is the timer tick with no
+ *         writer around.
+ *
+ *   @return Void.
+ **/
+static void console_flush()
+{
+    vterm_t *vt = vt_fg;
+    int row, offset;
+
+    /* the owner of the cells writes them without telling */
+    if (vt->owner != 0) {
+        vt->dirty_rows = ALL_ROWS;
+    }
+
+    if (vt->scroll_pending > 0) {
+        if (vt->scroll_pending < CONSOLE_HEIGHT &&
+            console_top + (vt->scroll_pending * CONSOLE_WIDTH) +
+            CONSOLE_SIZE <= VIDEO_MEM_ROWS * CONSOLE_WIDTH) {
+            /* the rows still on the screen are in video memory already */
+            console_top += vt->scroll_pending * CONSOLE_WIDTH;
+        }
+        else {
+            /* out of video memory, redraw at the start */
+            console_top = 0;
+            vt->dirty_rows = ALL_ROWS;
+        }
+        vt->scroll_pending = 0;
+    }
+
+    for (row = 0; vt->dirty_rows != 0; row++) {
+        if (vt->dirty_rows & ROW_BIT(row)) {
+            /* cleared first, a write racing with the copy marks it again */
+            vt->dirty_rows &= ~ROW_BIT(row);
+            memcpy(VIDEO_CELL(row, 0), CONSOLE_CELL(vt, row, 0),
+                   CONSOLE_WIDTH * sizeof(uint16_t));
+        }
+    }
+
+    if (console_top != console_hw_top) {
+        outb(CRTC_IDX_REG, CRTC_START_MSB_IDX);
+        outb(CRTC_DATA_REG, (console_top >> CHAR_BIT) & UCHAR_MAX);
+        outb(CRTC_IDX_REG, CRTC_START_LSB_IDX);
+        outb(CRTC_DATA_REG, console_top & UCHAR_MAX);
+
+        console_hw_top = console_top;
+    }
+
+    if (vt->cursor_is_visible) {
+        offset = console_top + vt->cursor_row * CONSOLE_WIDTH +
+                 vt->cursor_col;
+    }
+    else {
+        offset = (HIDE_OFFSET_MSB << CHAR_BIT) | HIDE_OFFSET_LSB;
+    }
 
-    if ((cons_cond_queue = queue_new()) == NULL) {
-        report_error(tag, "cons_init: fail to allocate cons_cond_queue");
+    if (offset != cursor_hw_offset) {
+        /* because the data register is 1 byte and the cursor offset is */
+        /* 16-bit, the offset is splitted into most and least significant */
+        /* 8 bits */
+        outb(CRTC_IDX_REG, CRTC_CURSOR_MSB_IDX);
+        outb(CRTC_DATA_REG, (offset >> CHAR_BIT) & UCHAR_MAX);
+        outb(CRTC_IDX_REG, CRTC_CURSOR_LSB_IDX);
+        outb(CRTC_DATA_REG, offset & UCHAR_MAX);
+
+        cursor_hw_offset = offset;
+    }
+}
+
+/** @brief Bring the terminal vt_switch asked for to the screen, if any, and
+ *         redraw all its rows. The caller holds outb_mp, or is the timer
+ *         tick with no writer around.
+ *
+ *   @return Void.
+ **/
+static void console_switch_pending()
+{
+    int if_was_set = if_disable();
+    vterm_t *vt;
+
+    if (vt_switch_pending < 0) {
+        if_recover(if_was_set);
+        return;
+    }
+
+    /* taken and made the foreground at once, so the tick does not do it
+     * again, and kept off its flush by the writer count
+     */
+    vt = &vterms[vt_switch_pending];
+    vt_switch_pending = -1;
+    vt->writers++;
+
+    vt_fg = vt;
+    vt->dirty_rows = ALL_ROWS;
+    vt->scroll_pending = 0;
+    if_recover(if_was_set);
+
+    console_flush();
+
+    if_was_set = if_disable();
+    vt->writers--;
+    if_recover(if_was_set);
+}
+
+/** @brief Start changing a terminal, the timer tick stays off video memory
+ *         until console_leave.
+ *
+ *   @param vt The terminal.
+ *
+ *   @return Void.
+ **/
+static void console_enter(vterm_t *vt)
+{
+    int if_was_set = if_disable();
+    vt->writers++;
+    if_recover(if_was_set);
+}
+
+/** @brief Done changing a terminal, flush it now in CONSOLE_MODE_SYNC if it
+ *         is on the screen.
+ *
+ *   @param vt The terminal.
+ *
+ *   @return Void.
+ **/
+static void console_leave(vterm_t *vt)
+{
+    int if_was_set;
+
+    if (console_mode == CONSOLE_MODE_SYNC) {
+        mutex_lock(&outb_mp);
+        if (vt == vt_fg) {
+            console_flush();
+        }
+        console_switch_pending();
+        mutex_unlock(&outb_mp);
+    }
+
+    if_was_set = if_disable();
+    vt->writers--;
+    if_recover(if_was_set);
+}
+
+void console_tick()
+{
+    vterm_t *vt = vt_fg;
+    int idx = vt_switch_pending;
+
+    /* neither terminal may be half written */
+    if (idx >= 0 && vt->writers == 0 && vterms[idx].writers == 0) {
+        console_switch_pending();
+        return;
+    }
+
+    if (vt->writers == 0 && (vt->dirty_rows != 0 || vt->scroll_pending > 0 ||
+                             vt->owner != 0 ||
+                             console_top != console_hw_top)) {
+        console_flush();
+    }
+}
+
+int console_set_mode(int mode)
+{
+    int old = console_mode;
+
+    if (mode != CONSOLE_MODE_SYNC && mode != CONSOLE_MODE_DEFERRED) {
         return -1;
     }
 
-    if (mutex_init(&outb_mp) != 0) {
-        report_error(tag, "cons_init: fail to initialize mutex");
+    /* leaving deferred mode flushes what the tick did not get to yet */
+    console_enter(vt_fg);
+    console_mode = mode;
+    console_leave(vt_fg);
+
+    return old;
+}
+
+/** @brief Reverse a run of cells in place.
+ *
+ *   @param cells The cells.
+ *   @param n The number of cells.
+ *
+ *   @return Void.
+ **/
+static void cells_reverse(uint16_t *cells, int n)
+{
+    uint16_t t;
+    int i;
+
+    for (i = 0; i < n / 2; i++) {
+        t = cells[i];
+        cells[i] = cells[n - 1 - i];
+        cells[n - 1 - i] = t;
+    }
+}
+
+int vt_map(vterm_t *vt, int pid)
+{
+    int if_was_set = if_disable();
+    int split;
+
+    if (vt->owner != 0 && vt->owner != pid) {
+        if_recover(if_was_set);
         return -1;
     }
 
-    clear_console();
+    /* the owner sees plain rows: rotate the ring so the top row is first,
+     * with nobody writing in between
+     */
+    split = vt->first * CONSOLE_WIDTH;
+    if (split != 0) {
+        cells_reverse(vt->cells, split);
+        cells_reverse(vt->cells + split, CONSOLE_SIZE - split);
+        cells_reverse(vt->cells, CONSOLE_SIZE);
+        vt->first = 0;
+    }
 
+    vt->owner = pid;
+    if_recover(if_was_set);
+
+    report_progress(tag, "vt_map: process %d owns terminal %d", pid,
+                    (int)(vt - vterms));
     return 0;
 }
 
+int vt_release(int pid)
+{
+    int if_was_set = if_disable();
+    int i, count = 0;
+
+    for (i = 0; i < NVTERMS; i++) {
+        if (vterms[i].owner == pid) {
+            vterms[i].owner = 0;
+            vterms[i].dirty_rows = ALL_ROWS;
+            count++;
+        }
+    }
 
-int putbyte(char ch)
+    if_recover(if_was_set);
+    return count;
+}
+
+int vt_blit(vterm_t *vt, int row, int col, int w, int h,
+            const uint16_t *cells)
 {
-    switch (ch) {
-        case '\n':
-            if (cursor_row + 1 == CONSOLE_HEIGHT) {
-                /* bottom row of the console, scroll up one line */
-                console_scroll_up();
-                set_cursor(CONSOLE_HEIGHT - 1, 0);
+    int i;
+
+    if (row < 0 || col < 0 || w <= 0 || h <= 0 ||
+        row + h > CONSOLE_HEIGHT || col + w > CONSOLE_WIDTH) {
+        return -1;
+    }
+
+    console_enter(vt);
+
+    for (i = 0; i < h; i++) {
+        memcpy(CONSOLE_CELL(vt, row + i, col), cells + i * w,
+               w * sizeof(uint16_t));
+        vt->dirty_rows |= ROW_BIT(row + i);
+    }
+
+    console_leave(vt);
+    return 0;
+}
+
+int vt_switch(int idx)
+{
+    if (vt_get(idx) == NULL) {
+        return -1;
+    }
+
+    /* the interrupted thread may hold outb_mp, leave it to the tick */
+    vt_switch_pending = idx;
+
+    report_progress(tag, "vt_switch: terminal %d asked for", idx);
+    return 0;
+}
+
+/** @brief Move the cursor of a terminal to the beginning of the next row,
+ *         scrolling up if it is on the bottom row.
+ *
+ *   @param vt The terminal.
+ *
+ *   @return Void.
+ **/
+static void cursor_newline(vterm_t *vt)
+{
+    if (vt->cursor_row + 1 == CONSOLE_HEIGHT) {
+        /* bottom row of the console, scroll up one line */
+        console_scroll_up(vt);
+    }
+    else {
+        vt->cursor_row++;
+    }
+    vt->cursor_col = 0;
+}
+
+/** @brief Blank the cells of a row of a terminal from column from up to,
+ *         but not including, column to.
+ *
+ *   @param vt The terminal.
+ *   @param row The row.
+ *   @param from The first column.
+ *   @param to The column after the last one.
+ *
+ *   @return Void.
+ **/
+static void console_erase(vterm_t *vt, int row, int from, int to)
+{
+    uint16_t *cell = CONSOLE_CELL(vt, row, 0);
+    int j;
+
+    for (j = from; j < to; j++) {
+        cell[j] = CELL(' ', vt->term_color);
+    }
+    vt->dirty_rows |= ROW_BIT(row);
+}
+
+/** @brief Apply a select graphic rendition (ESC [ ... m) parameter to the
+ *         color of a terminal. Unknown ones are ignored.
+ *
+ *   @param vt The terminal.
+ *   @param p The parameter.
+ *
+ *   @return Void.
+ **/
+static void console_sgr(vterm_t *vt, int p)
+{
+    int color = vt->term_color;
+
+    if (p == 0) {
+        color = DEFAULT_COLOR;
+    }
+    else if (p == 1) {
+        color |= COLOR_BRIGHT;
+    }
+    else if (p == 22) {
+        color &= ~COLOR_BRIGHT;
+    }
+    else if (p == 5) {
+        color |= BLINK;
+    }
+    else if (p == 25) {
+        color &= ~BLINK;
+    }
+    else if (p >= 30 && p <= 37) {
+        /* keeps the bright bit */
+        color = (color & ~(COLOR_FGND & ~COLOR_BRIGHT)) | ansi_colors[p - 30];
+    }
+    else if (p == 39) {
+        color = (color & ~COLOR_FGND) | (DEFAULT_COLOR & COLOR_FGND);
+    }
+    else if (p >= 40 && p <= 47) {
+        color = (color & ~COLOR_BGND) | (ansi_colors[p - 40] << 4);
+    }
+    else if (p == 49) {
+        color = (color & ~COLOR_BGND) | (DEFAULT_COLOR & COLOR_BGND);
+    }
+    else if (p >= 90 && p <= 97) {
+        color = (color & ~COLOR_FGND) | ansi_colors[p - 90] | COLOR_BRIGHT;
+    }
+
+    vt->term_color = color & UCHAR_MAX;
+}
+
+/** @brief Carry out the control sequence ESC [ params final on a terminal.
+ *         Unknown ones are ignored.
+ *
+ *   @param vt The terminal.
+ *   @param final The last character of the sequence.
+ *
+ *   @return Void.
+ **/
+static void console_csi(vterm_t *vt, char final)
+{
+    int n = vt->esc_params[0];
+    int count = (n > 0) ? n : 1;
+    int i;
+
+    switch (final) {
+        case 'H':
+        case 'f':
+            /* 1-based, missing or 0 means 1 */
+            vt->cursor_row = count - 1;
+            vt->cursor_col = ((vt->esc_params[1] > 0) ?
+                              vt->esc_params[1] : 1) - 1;
+            if (vt->cursor_row >= CONSOLE_HEIGHT) {
+                vt->cursor_row = CONSOLE_HEIGHT - 1;
             }
-            else {
-                set_cursor(cursor_row + 1, 0);
+            if (vt->cursor_col >= CONSOLE_WIDTH) {
+                vt->cursor_col = CONSOLE_WIDTH - 1;
+            }
+            break;
+
+        case 'A':
+            vt->cursor_row = (vt->cursor_row > count) ?
+                             vt->cursor_row - count : 0;
+            break;
+
+        case 'B':
+            vt->cursor_row = (vt->cursor_row + count < CONSOLE_HEIGHT) ?
+                             vt->cursor_row + count : CONSOLE_HEIGHT - 1;
+            break;
+
+        case 'C':
+            vt->cursor_col = (vt->cursor_col + count < CONSOLE_WIDTH) ?
+                             vt->cursor_col + count : CONSOLE_WIDTH - 1;
+            break;
+
+        case 'D':
+            vt->cursor_col = (vt->cursor_col > count) ?
+                             vt->cursor_col - count : 0;
+            break;
+
+        case 'J':
+            /* 0: from the cursor on, 1: up to the cursor, 2: all */
+            for (i = 0; i < CONSOLE_HEIGHT; i++) {
+                if (i == vt->cursor_row && n != 2) {
+                    if (n == 0) {
+                        console_erase(vt, i, vt->cursor_col, CONSOLE_WIDTH);
+                    }
+                    else {
+                        console_erase(vt, i, 0, vt->cursor_col + 1);
+                    }
+                }
+                else if (n == 2 || (n == 0 && i > vt->cursor_row) ||
+                         (n == 1 && i < vt->cursor_row)) {
+                    console_erase(vt, i, 0, CONSOLE_WIDTH);
+                }
+            }
+            break;
+
+        case 'K':
+            /* the same, within the row of the cursor */
+            if (n == 0) {
+                console_erase(vt, vt->cursor_row, vt->cursor_col,
+                              CONSOLE_WIDTH);
+            }
+            else if (n == 1) {
+                console_erase(vt, vt->cursor_row, 0, vt->cursor_col + 1);
+            }
+            else if (n == 2) {
+                console_erase(vt, vt->cursor_row, 0, CONSOLE_WIDTH);
+            }
+            break;
+
+        case 'm':
+            /* ESC [ m is ESC [ 0 m */
+            console_sgr(vt, n);
+            for (i = 1; i < vt->esc_nparams && i < VT_ESC_PARAMS; i++) {
+                console_sgr(vt, vt->esc_params[i]);
+            }
+            break;
+
+        case 's':
+            vt->saved_row = vt->cursor_row;
+            vt->saved_col = vt->cursor_col;
+            break;
+
+        case 'u':
+            vt->cursor_row = vt->saved_row;
+            vt->cursor_col = vt->saved_col;
+            break;
+
+        case 'h':
+        case 'l':
+            if (vt->esc_private && n == 25) {
+                vt->cursor_is_visible = (final == 'h');
             }
             break;
+    }
+}
+
+/** @brief Feed a character to the escape sequence parser of a terminal.
+ *
+ *   @param vt The terminal.
+ *   @param ch The character, ESC or one that follows it.
+ *
+ *   @return 1 if the parser took the character, 0 if it is not part of a
+ *           sequence and gets printed as usual.
+ **/
+static int console_escape(vterm_t *vt, char ch)
+{
+    int *p;
+
+    if (ch == ESC) {
+        /* starts over, even in the middle of another sequence */
+        vt->esc_state = ESC_START;
+        return 1;
+    }
+
+    if (vt->esc_state == ESC_START) {
+        if (ch != '[') {
+            /* not a sequence we know, the character is just printed */
+            vt->esc_state = ESC_NONE;
+            return 0;
+        }
+
+        vt->esc_state = ESC_CSI;
+        vt->esc_private = 0;
+        vt->esc_nparams = 0;
+        memset(vt->esc_params, 0, sizeof(vt->esc_params));
+        return 1;
+    }
+
+    /* control characters cut the sequence short and do what they do */
+    if ((unsigned char)ch < ' ') {
+        vt->esc_state = ESC_NONE;
+        return 0;
+    }
+
+    if (ch >= '0' && ch <= '9') {
+        if (vt->esc_nparams == 0) {
+            vt->esc_nparams = 1;
+        }
+        if (vt->esc_nparams <= VT_ESC_PARAMS) {
+            p = &(vt->esc_params[vt->esc_nparams - 1]);
+            if (*p <= ESC_PARAM_MAX) {
+                *p = *p * 10 + (ch - '0');
+            }
+        }
+    }
+    else if (ch == ';') {
+        if (vt->esc_nparams == 0) {
+            vt->esc_nparams = 1;
+        }
+        if (vt->esc_nparams <= VT_ESC_PARAMS) {
+            vt->esc_nparams++;
+        }
+    }
+    else if (ch == '?' && vt->esc_nparams == 0) {
+        vt->esc_private = 1;
+    }
+    else if (ch >= '@' && ch <= '~') {
+        /* the final character */
+        vt->esc_state = ESC_NONE;
+        console_csi(vt, ch);
+    }
+
+    return 1;
+}
+
+/** @brief Write a character at the cursor of a terminal and move the
+ *         cursor past it, without touching the CRTC.
+ *
+ *   @param vt The terminal.
+ *   @param ch The character to write.
+ *
+ *   @return Void.
+ **/
+static void console_put(vterm_t *vt, char ch)
+{
+    if ((vt->esc_state != ESC_NONE || ch == ESC) && console_escape(vt, ch)) {
+        return;
+    }
+
+    switch (ch) {
+        case '\n':
+            cursor_newline(vt);
+            break;
 
         case '\r':
             /* overwrites from the beginning of the line */
-            set_cursor(cursor_row, 0);
+            vt->cursor_col = 0;
             break;
 
         case '\b':
-            if (cursor_col == 0) {
-                if (cursor_row == 0) {
+            if (vt->cursor_col == 0) {
+                if (vt->cursor_row == 0) {
                     /* do nothing if at the right top cornor of the console */
                     break;
                 }
                 else {
                     /* delete character at the beginning of the line */
-                    set_cursor(cursor_row - 1, find_last_char(cursor_row - 1));
+                    vt->cursor_col = find_last_char(vt, vt->cursor_row - 1);
+                    vt->cursor_row--;
                 }
             }
             else {
-                set_cursor(cursor_row, cursor_col - 1);
+                vt->cursor_col--;
             }
-            draw_char(cursor_row, cursor_col, ' ', term_color);
+            *CONSOLE_CELL(vt, vt->cursor_row, vt->cursor_col) =
+                CELL(' ', vt->term_color);
+            vt->dirty_rows |= ROW_BIT(vt->cursor_row);
             break;
 
         default:
-            draw_char(cursor_row, cursor_col, ch, term_color);
-            if (cursor_col + 1 == CONSOLE_WIDTH) {
-                if (cursor_row + 1 == CONSOLE_HEIGHT) {
-                    /* the last row of the console is full */
-                    console_scroll_up();
-                    set_cursor(CONSOLE_HEIGHT - 1, 0);
-                }
-                else {
-                    /* write to the beginning of the next row */
-                    set_cursor(cursor_row + 1, 0);
-                }
-            }
-            else {
-                set_cursor(cursor_row, cursor_col + 1);
+            *CONSOLE_CELL(vt, vt->cursor_row, vt->cursor_col) =
+                CELL(ch, vt->term_color);
+            vt->dirty_rows |= ROW_BIT(vt->cursor_row);
+            if (++vt->cursor_col == CONSOLE_WIDTH) {
+                /* write to the beginning of the next row */
+                cursor_newline(vt);
             }
     }
+}
 
-    return (int)ch;
+/** @brief Write a run of characters without control characters or ESC at the
+ *         cursor of a terminal, up to the end of the row, and move the
+ *         cursor past it.
+ *
+ *   @param vt The terminal.
+ *   @param s The characters.
+ *   @param len The most characters to write.
+ *
+ *   @return The characters written.
+ **/
+static int console_put_run(vterm_t *vt, const char *s, int len)
+{
+    uint16_t *cell = CONSOLE_CELL(vt, vt->cursor_row, vt->cursor_col);
+    int color = vt->term_color;
+    int i;
+
+    if (len > CONSOLE_WIDTH - vt->cursor_col) {
+        len = CONSOLE_WIDTH - vt->cursor_col;
+    }
+
+    for (i = 0; i < len && s[i] != '\n' && s[i] != '\r' && s[i] != '\b' &&
+         s[i] != ESC; i++) {
+        cell[i] = CELL(s[i], color);
+    }
+
+    if (i > 0) {
+        vt->dirty_rows |= ROW_BIT(vt->cursor_row);
+    }
+
+    vt->cursor_col += i;
+    if (vt->cursor_col == CONSOLE_WIDTH) {
+        cursor_newline(vt);
+    }
+
+    return i;
 }
 
-void putbytes(const char *s, int len)
+/** @brief Send what a terminal prints to the serial port, if it is the
+ *         foreground one and the port is a console.
+ *
+ *   @param vt The terminal.
+ *   @param s The characters.
+ *   @param len The number of characters.
+ *
+ *   @return 1 if the screen is left alone, 0 if not.
+ **/
+static int console_serial(vterm_t *vt, const char *s, int len)
 {
-  if (s == NULL || len <= 0) {
-    return;
-  }
+    int mode;
 
-  else {
-    int i;
-    for (i = 0; i < len; i++) {
-      putbyte(s[i]);
+    if (vt != vt_fg || (mode = serial_console_mode()) == SERIAL_CONSOLE_OFF) {
+        return 0;
     }
-    return;
-  }
+
+    serial_write(s, len);
+    return mode == SERIAL_CONSOLE_REDIRECT;
 }
 
-void console_scroll_up()
+int vt_putbyte(vterm_t *vt, char ch)
 {
-  int i, j;
-  int ch, color;
-  for (i = 1; i < CONSOLE_HEIGHT; i++) {
-    for (j = 0; j < CONSOLE_WIDTH; j++) {
-      /* copy each row to its previous row */
-      ch = (int)get_char(i, j);
-      color = (int)get_color(i, j);
-      draw_char(i - 1, j, ch, color);
+    if (console_serial(vt, &ch, 1)) {
+        return (int)ch;
     }
+
+    console_enter(vt);
+    console_put(vt, ch);
+    console_leave(vt);
+
+    return (int)ch;
+}
+
+int putbyte(char ch)
+{
+    return vt_putbyte(vt_running(), ch);
+}
+
+void vt_putbytes(vterm_t *vt, const char *s, int len)
+{
+    int i, run;
+
+    if (s == NULL || len <= 0) {
+        return;
+    }
+
+    if (console_serial(vt, s, len)) {
+        return;
+    }
+
+    console_enter(vt);
+
+    i = 0;
+    while (i < len) {
+        /* plain text goes a row at a time, escape sequences a character at
+         * a time
+         */
+        if (vt->esc_state != ESC_NONE ||
+            (run = console_put_run(vt, s + i, len - i)) == 0) {
+            console_put(vt, s[i]);
+            run = 1;
+        }
+        i += run;
+    }
+
+    /* the screen and the cursor only get updated once */
+    console_leave(vt);
+}
+
+void putbytes(const char *s, int len)
+{
+    vt_putbytes(vt_running(), s, len);
+}
+
+static void console_scroll_up(vterm_t *vt)
+{
+  uint16_t *last_row;
+  int j;
+
+  if (vt->owner != 0) {
+    /* the owner sees plain rows, move them up */
+    memmove(vt->cells, vt->cells + CONSOLE_WIDTH,
+            (CONSOLE_SIZE - CONSOLE_WIDTH) * sizeof(uint16_t));
+  }
+  else {
+    /* the top row of the ring becomes the bottom one */
+    vt->first = (vt->first + 1) % CONSOLE_HEIGHT;
   }
 
-  for(j = 0; j < CONSOLE_WIDTH; j++) {
+  last_row = CONSOLE_CELL(vt, CONSOLE_HEIGHT - 1, 0);
+  for (j = 0; j < CONSOLE_WIDTH; j++) {
     /* clear the last row */
-    draw_char(CONSOLE_HEIGHT - 1, j, ' ', term_color);
+    last_row[j] = CELL(' ', vt->term_color);
   }
+
+  /* the dirty rows move up with the text, console_flush slides the video
+   * memory window the same way
+   */
+  vt->dirty_rows = (vt->dirty_rows >> 1) | ROW_BIT(CONSOLE_HEIGHT - 1);
+  vt->scroll_pending++;
   return;
 }
 
@@ -219,7 +969,7 @@ int set_term_color(int color)
   }
 
   else {
-    term_color = color;
+    vt_running()->term_color = color;
     return 0;
   }
 }
@@ -232,47 +982,35 @@ void get_term_color(int *color)
   }
 
   else {
-    *color = term_color;
+    *color = vt_running()->term_color;
     return;
   }
 }
 
 int set_cursor(int row, int col)
 {
+  vterm_t *vt = vt_running();
+
   /* check if the row and col index are within bound */
   if (row < 0 || row >= CONSOLE_HEIGHT ||
       col < 0 || col >= CONSOLE_WIDTH) {
     return -1;
   }
 
-  else if (!cursor_is_visible) {
-    /* if cursor is invisible, remember the new location of the cursor, but */
-    /* don't show the cursor immediately, wait for show_cursor() to do that */
-    cursor_row = row;
-    cursor_col = col;
-    return 0;
-  }
-
   else {
-    cursor_row = row;
-    cursor_col = col;
-
-    mutex_lock(&outb_mp);
-
-    /* because the data register is 1 byte and the cursor offset is 16-bit, */
-    /* the offset is splitted into most and least significant 8 bits */
-    outb(CRTC_IDX_REG, CRTC_CURSOR_MSB_IDX);
-    outb(CRTC_DATA_REG, get_offset_msb());
-    outb(CRTC_IDX_REG, CRTC_CURSOR_LSB_IDX);
-    outb(CRTC_DATA_REG, get_offset_lsb());
-
-    mutex_unlock(&outb_mp);
+    /* if cursor is invisible, console_flush only remembers the location */
+    console_enter(vt);
+    vt->cursor_row = row;
+    vt->cursor_col = col;
+    console_leave(vt);
     return 0;
   }
 }
 
 void get_cursor(int *row, int *col)
 {
+  vterm_t *vt = vt_running();
+
   /* make sure the memory locations are not NULL */
   if (row == NULL || col == NULL) {
     return;
@@ -281,92 +1019,81 @@ void get_cursor(int *row, int *col)
   else {
     /* it fetches the true location of the cursor, no matter the cursor is */
     /* visible or not */
-    *row = cursor_row;
-    *col = cursor_col;
+    *row = vt->cursor_row;
+    *col = vt->cursor_col;
     return;
   }
 }
 
 void hide_cursor()
 {
-  if (!cursor_is_visible) {
+  vterm_t *vt = vt_running();
+
+  if (!vt->cursor_is_visible) {
     /* do nothing if the cursor is invisible already */
     return;
   }
 
   else {
-    mutex_lock(&outb_mp);
-
-    /* because the data register is 1 byte and the cursor offset is 16-bit, */
-    /* the offset is splitted into most and least significant 8 bits */
-    outb(CRTC_IDX_REG, CRTC_CURSOR_MSB_IDX);
-    outb(CRTC_DATA_REG, (uint8_t)HIDE_OFFSET_MSB);
-    outb(CRTC_IDX_REG, CRTC_CURSOR_LSB_IDX);
-    outb(CRTC_DATA_REG, (uint8_t)HIDE_OFFSET_LSB);
-
-    mutex_unlock(&outb_mp);
-
-    cursor_is_visible = 0;
+    /* console_flush moves the cursor off the screen */
+    console_enter(vt);
+    vt->cursor_is_visible = 0;
+    console_leave(vt);
     return;
   }
 }
 
 void show_cursor()
 {
-  if (cursor_is_visible) {
+  vterm_t *vt = vt_running();
+
+  if (vt->cursor_is_visible) {
     /* do nothing if the cursor is visible already */
     return;
   }
 
   else {
-    mutex_lock(&outb_mp);
-
-    /* because the data register is 1 byte and the cursor offset is 16-bit, */
-    /* the offset is splitted into most and least significant 8 bits */
-    outb(CRTC_IDX_REG, CRTC_CURSOR_MSB_IDX);
-    outb(CRTC_DATA_REG, get_offset_msb());
-    outb(CRTC_IDX_REG, CRTC_CURSOR_LSB_IDX);
-    outb(CRTC_DATA_REG, get_offset_lsb());
-
-    mutex_unlock(&outb_mp);
-
-    cursor_is_visible = 1;
+    /* put it back where it was hidden */
+    console_enter(vt);
+    vt->cursor_is_visible = 1;
+    console_leave(vt);
     return;
   }
 }
 
-uint8_t get_offset_msb()
+static void vt_clear(vterm_t *vt)
 {
-  return ((cursor_row * CONSOLE_WIDTH + cursor_col) >> CHAR_BIT) & UCHAR_MAX;
-}
+  int i, j;
 
-uint8_t get_offset_lsb()
-{
-  return (cursor_row * CONSOLE_WIDTH + cursor_col) & UCHAR_MAX;
-}
+  console_enter(vt);
 
-void clear_console()
-{
-  int i, j;
   for (i = 0; i < CONSOLE_HEIGHT; i++) {
     for (j = 0; j < CONSOLE_WIDTH; j++) {
       /* clear each element in the console */
-      draw_char(i, j, ' ', DEFAULT_COLOR);
+      *CONSOLE_CELL(vt, i, j) = CELL(' ', DEFAULT_COLOR);
     }
   }
+  vt->dirty_rows = ALL_ROWS;
 
   /* set the cursor to the console's top left corner */
-  set_cursor(0, 0);
+  vt->cursor_row = 0;
+  vt->cursor_col = 0;
+  console_leave(vt);
   return;
 }
 
-int find_last_char(int row)
+void clear_console()
+{
+  vt_clear(vt_running());
+}
+
+static int find_last_char(vterm_t *vt, int row)
 {
   int j;
   char ch;
   for (j = CONSOLE_WIDTH - 1; j >= 0; j--) {
     /* check each character from the end of the line */
-    ch = get_char(row, j);
+    ch = (char)*CONSOLE_CELL(vt, row, j);
     if (ch != ' ') {
       return j;
     }
@@ -386,6 +1113,8 @@ int find_last_char(int row)
  **/
 void draw_char(int row, int col, int ch, int color)
 {
+  vterm_t *vt = vt_running();
+
   /* check if the row and col index are within bound */
   if (row < 0 || row >= CONSOLE_HEIGHT ||
       col < 0 || col >= CONSOLE_WIDTH) {
@@ -398,9 +1127,11 @@ void draw_char(int row, int col, int ch, int color)
   }
 
   else {
-    /* write the byte pair to video memory */
-    *(char *)(CONSOLE_MEM_BASE + 2*(row * CONSOLE_WIDTH + col)) = ch;
-    *(char *)(CONSOLE_MEM_BASE + 2*(row * CONSOLE_WIDTH + col) + 1) = color;
+    /* write the byte pair to the terminal, console_flush copies it */
+    console_enter(vt);
+    *CONSOLE_CELL(vt, row, col) = CELL(ch, color);
+    vt->dirty_rows |= ROW_BIT(row);
+    console_leave(vt);
     return;
   }
 }
@@ -415,7 +1146,7 @@ char get_color(int row, int col)
   }
 
   else {
-    return *(char *)(CONSOLE_MEM_BASE + 2*(row * CONSOLE_WIDTH + col) + 1);
+    return (char)(*CONSOLE_CELL(vt_running(), row, col) >> CHAR_BIT);
   }
 }
 
@@ -435,6 +1166,6 @@ char get_char(int row, int col)
   }
 
   else {
-    return *(char *)(CONSOLE_MEM_BASE + 2*(row * CONSOLE_WIDTH + col));
+    return (char)*CONSOLE_CELL(vt_running(), row, col);
   }
 }
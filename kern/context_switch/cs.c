@@ -14,6 +14,8 @@
 #include <reporter.h>
 #include <asm.h>
 #include <kthread_pool.h>
+#include <sysenter.h>
+#include <vdso.h>
 
 static char *tag = "cs";
 
@@ -56,6 +58,8 @@ void cs_switch(unsigned long edi, unsigned long esi, unsigned long ebp,
 
     report_misc(tag, "going to set esp0");
     set_esp0(to->regs->esp0);
+    sysenter_set_esp0(to->regs->esp0);
+    vdso_set_tid(to->tcb->tid);
 
     report_misc(tag, "going to set cr3");
     set_cr3(to->tcb->pcb->pgd);
@@ -0,0 +1,61 @@
+/** @file kern/data_structure/mpsc_queue.c
+ *
+ *  @brief multi producer, single consumer queue implementation
+ *
+ *  @author An Wu (anwu)
+ *  @author Hingon Miu (hmiu)
+ *
+ */
+
+#include <mpsc_queue.h>
+#include <stddef.h>
+#include <asm.h>
+
+void mpsc_init(mpsc_queue_t *q) {
+    q->stub.next = NULL;
+    q->head = &(q->stub);
+    q->tail = &(q->stub);
+}
+
+void mpsc_push(mpsc_queue_t *q, mpsc_node_t *n) {
+    mpsc_node_t *prev;
+
+    n->next = NULL;
+
+    /* take the tail, then link the node behind the one before it */
+    prev = (mpsc_node_t *)xchg((int *)&(q->tail), (int)n);
+    prev->next = n;
+}
+
+mpsc_node_t *mpsc_pop(mpsc_queue_t *q) {
+    mpsc_node_t *head = q->head;
+    mpsc_node_t *next = head->next;
+
+    /* step over the stub */
+    if (head == &(q->stub)) {
+        if (next == NULL)
+            return NULL;
+        q->head = next;
+        head = next;
+        next = next->next;
+    }
+
+    if (next != NULL) {
+        q->head = next;
+        return head;
+    }
+
+    /* a push is halfway, its node is not linked yet */
+    if (head != q->tail)
+        return NULL;
+
+    /* head is the last node, put the stub behind it to take it */
+    mpsc_push(q, &(q->stub));
+
+    if ((next = head->next) != NULL) {
+        q->head = next;
+        return head;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,70 @@
+/** @file kern/data_structure/spsc_ring.c
+ *
+ *  @brief single producer, single consumer byte ring implementation
+ *
+ *  There is one CPU and x86 keeps stores in order, so the only reordering
+ *  to stop is the compiler's: the producer writes the byte before it
+ *  publishes tail, the consumer reads the byte before it gives the slot
+ *  back through head.
+ *
+ *  @author An Wu (anwu)
+ *  @author Hingon Miu (hmiu)
+ *
+ */
+
+#include <spsc_ring.h>
+#include <stddef.h>
+#include <reporter.h>
+
+/* keep the compiler from moving memory accesses across this point */
+#define COMPILER_BARRIER() asm volatile ("" : : : "memory")
+
+static const char *tag = "spsc_ring";
+
+int spsc_init(spsc_ring_t *r, unsigned char *buf, unsigned int len) {
+    /* check args */
+    if (r == NULL || buf == NULL || len == 0 || (len & (len - 1)) != 0) {
+        report_error(tag, "wrong input to init");
+        return -1;
+    }
+
+    r->buf = buf;
+    r->mask = len - 1;
+    r->head = 0;
+    r->tail = 0;
+
+    return 0;
+}
+
+int spsc_put(spsc_ring_t *r, unsigned char c) {
+    unsigned int tail = r->tail;
+
+    /* full */
+    if (tail - r->head > r->mask)
+        return -1;
+
+    r->buf[tail & r->mask] = c;
+    COMPILER_BARRIER();
+    r->tail = tail + 1;
+
+    return 0;
+}
+
+int spsc_get(spsc_ring_t *r, unsigned char *c) {
+    unsigned int head = r->head;
+
+    /* empty */
+    if (head == r->tail)
+        return -1;
+
+    COMPILER_BARRIER();
+    *c = r->buf[head & r->mask];
+    COMPILER_BARRIER();
+    r->head = head + 1;
+
+    return 0;
+}
+
+int spsc_empty(spsc_ring_t *r) {
+    return r->head == r->tail;
+}
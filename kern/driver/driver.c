@@ -10,6 +10,7 @@
 #include <x86/asm.h>
 #include <key_driver.h>
 #include <timer_driver.h>
+#include <serial_driver.h>
 #include <reporter.h>
 
 static char *tag = "driver";
@@ -25,12 +26,22 @@ int handler_install(void (*tickback)(unsigned int)) {
     key_init(idt_base_p);
     report_progress(tag, "key init done!");
 
+    /* no serial port is no error, the console just stays on the screen */
+    if (serial_init(idt_base_p) == 0)
+        report_progress(tag, "serial init done!");
+
     return 0;
 }
 
 
 int readchar(void)
 {
-    return key_readchar();
+    int c = key_readchar();
+
+    /* the serial port is a second keyboard */
+    if (c == -1)
+        c = serial_readchar();
+
+    return c;
 }
 
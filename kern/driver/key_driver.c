@@ -17,15 +17,30 @@
 #include <sched.h>
 #include <context_switch.h>
 #include <console.h>
-#include <circ_buf.h>
+#include <spsc_ring.h>
+#include <asm.h>
 #include <mutex.h>
 #include <reporter.h>
 #include <syscall_handler.h>
 
 #define KEYBOARD_BUFFER_SIZE 128
 
-/* keyboard buffer */
-static circ_buf_t k_buf;
+/* the scancodes (set 1) of Alt and F1, Alt+F1 and on switch terminals */
+#define SCANCODE_ALT_MAKE 0x38
+#define SCANCODE_ALT_BREAK 0xb8
+#define SCANCODE_F1_MAKE 0x3b
+
+/* the raw scancodes, put by the interrupt handler and decoded by readchar */
+static unsigned char k_ring_buf[KEYBOARD_BUFFER_SIZE];
+static spsc_ring_t k_ring;
+
+/* whether a thread is decoding scancodes, process_scancode keeps the shift
+ * state so they have to go through it one at a time and in order
+ */
+static int decoding = 0;
+
+/* whether Alt is held down */
+static int alt_down = 0;
 
 static char *tag = "key_driver";
 
@@ -36,24 +51,33 @@ static char *tag = "key_driver";
 void keyboard_handler() {
     report_misc(tag, "KEYBOARD INTERRUPT");
      
-    char c = inb(KEYBOARD_PORT);
-    cb_put(&k_buf, c);
+    int sc = (unsigned char)inb(KEYBOARD_PORT);
+    int vt_idx = -1;
+
+    if (sc == SCANCODE_ALT_MAKE)
+        alt_down = 1;
+    else if (sc == SCANCODE_ALT_BREAK)
+        alt_down = 0;
+
+    /* Alt+Fn is not typed into any terminal */
+    if (alt_down && sc >= SCANCODE_F1_MAKE &&
+        sc < SCANCODE_F1_MAKE + NVTERMS)
+        vt_idx = sc - SCANCODE_F1_MAKE;
+    else if (spsc_put(&k_ring, sc) != 0)
+        report_warning(tag, "keyboard buffer full, scancode dropped");
+
     outb(INT_CTL_PORT, INT_ACK_CURRENT);  // tell PIC 'done'
     
     /* enable interrupts before trying to fill console */ 
     enable_interrupts();
 
-    /* signal the first waiting readline/getchar */
-    cond_t *cv_p;
-    mutex_lock(&(cons_cond_queue->mp));
-    if ((cv_p = peek(cons_cond_queue)) != NULL) {
-        mutex_unlock(&(cons_cond_queue->mp));
-        fill_cons();
-    }
-    else {
-        mutex_unlock(&(cons_cond_queue->mp));
-    }
+    if (vt_idx >= 0)
+        vt_switch(vt_idx);
 
+    /* feed the line of the foreground terminal if a readline/getchar waits */
+    vterm_t *vt = vt_foreground();
+    if (ldisc_waiting(&(vt->in)))
+        fill_cons(vt);
 }
 
 
@@ -63,11 +87,11 @@ void keyboard_handler() {
  *  @return Void
  */
 int key_init(void *idt_base_p) {
-    if (cb_init(&k_buf, KEYBOARD_BUFFER_SIZE) != 0) {
-        report_error(tag, "cb_init failed");
+    if (spsc_init(&k_ring, k_ring_buf, KEYBOARD_BUFFER_SIZE) != 0) {
+        report_error(tag, "spsc_init failed");
         return -1;
     }
-    report_progress(tag, "circ_buf init done!");
+    report_progress(tag, "spsc_ring init done!");
 
     install_desc(idt_base_p, KEY_IDT_ENTRY, keyboard_wrapper, 
                     interrupt_gate, 0);
@@ -78,21 +102,31 @@ int key_init(void *idt_base_p) {
 
 int key_readchar(void)
 {
-    char c = cb_get(&k_buf);
-
-    if (c == -1) {    // buffer empty
-        return -1;
-    }
+    unsigned char sc;
+    kh_type augchar;
+
+    /* a caller that finds another one decoding (it interrupted it) leaves
+     * the scancodes to that one
+     */
+    while (xchg(&decoding, 1) == 0) {
+        /* skip the breaks and modifiers up to the next char */
+        while (spsc_get(&k_ring, &sc) == 0) {
+            augchar = process_scancode(sc);
+
+            if (KH_HASDATA(augchar) && KH_ISMAKE(augchar)) {
+                decoding = 0;
+                return KH_GETCHAR(augchar);
+            }
+        }
 
-    else {
-        kh_type augchar = process_scancode(c);  
+        decoding = 0;
 
-        if (KH_HASDATA(augchar) && KH_ISMAKE(augchar)) { // char available
-            return KH_GETCHAR(augchar);
-        }
-        else {
-            return key_readchar();
-        }
+        /* look again, a scancode may have come in for a caller that could
+         * not decode it after we found the ring empty
+         */
+        if (spsc_empty(&k_ring))
+            break;
     }
-}
 
+    return -1;
+}
@@ -0,0 +1,312 @@
+/** @file kern/serial_driver.c
+ *
+ *  @brief interrupt driven 16550 (COM1) driver
+ *
+ *  Sending copies into the transmit ring and, if the port is idle, fills
+ *  its FIFO right away; the transmitter empty interrupt refills it 16
+ *  bytes at a time until the ring is empty, then turns itself off. The
+ *  receive interrupt (data or FIFO timeout) drains the FIFO into the
+ *  receive ring, and wakes a readline the way the keyboard does.
+ *
+ *  @author Hingon Miu (hmiu)
+ *  @author An Wu (anwu)
+ */
+
+#include <serial_driver.h>
+#include <x86/asm.h>
+#include <interrupt_defines.h>
+#include <simics.h>
+#include <stddef.h>
+#include <serial_wrapper.h>
+#include <install_desc.h>
+#include <console.h>
+#include <mutex.h>
+#include <if_flag.h>
+#include <reporter.h>
+#include <syscall_handler.h>
+
+/* the I/O ports of COM1 */
+#define COM1_BASE 0x3f8
+#define UART_DATA (COM1_BASE + 0)     /* RBR/THR, DLL with DLAB */
+#define UART_IER (COM1_BASE + 1)      /* DLM with DLAB */
+#define UART_IIR (COM1_BASE + 2)      /* FCR on write */
+#define UART_FCR (COM1_BASE + 2)
+#define UART_LCR (COM1_BASE + 3)
+#define UART_MCR (COM1_BASE + 4)
+#define UART_LSR (COM1_BASE + 5)
+#define UART_MSR (COM1_BASE + 6)
+#define UART_SCR (COM1_BASE + 7)
+
+/* IER: receive data available, transmitter empty */
+#define IER_RX 0x01
+#define IER_TX 0x02
+
+/* IIR: no interrupt pending, and the interrupt id */
+#define IIR_NONE 0x01
+#define IIR_ID(iir) ((iir) & 0x0e)
+#define IIR_MODEM 0x00
+#define IIR_TX_EMPTY 0x02
+#define IIR_RX_DATA 0x04
+#define IIR_LINE 0x06
+#define IIR_RX_TIMEOUT 0x0c
+
+/* FCR: FIFOs on and cleared, receive interrupt at 14 bytes */
+#define FCR_ENABLE 0xc7
+
+/* LCR: 8 data bits, no parity, 1 stop bit, and the divisor latch */
+#define LCR_8N1 0x03
+#define LCR_DLAB 0x80
+
+/* MCR: DTR, RTS and OUT2, which connects the interrupt line */
+#define MCR_DTR_RTS_OUT2 0x0b
+
+/* LSR: data ready, transmitter holding register empty */
+#define LSR_DR 0x01
+#define LSR_THRE 0x20
+
+/* the bytes the transmit FIFO takes at once */
+#define UART_FIFO_LEN 16
+
+/* the clock of the baud rate divisor */
+#define UART_CLOCK 115200
+
+/* COM1 is IRQ 4, and the master PIC mask register */
+#define SERIAL_IRQ 4
+#define SERIAL_IDT_ENTRY (0x20 + SERIAL_IRQ)
+#define PIC_MASTER_IMR 0x21
+
+/* the rings, powers of 2 so the free running indices wrap right */
+#define TX_RING_LEN 8192
+#define RX_RING_LEN 256
+
+/* the characters a terminal sends for enter and backspace */
+#define SERIAL_CR '\r'
+#define SERIAL_DEL 0x7f
+
+static char *tag = "serial_driver";
+
+/* the transmit ring, tx_head is the next byte to send */
+static char tx_ring[TX_RING_LEN];
+static unsigned int tx_head = 0;
+static unsigned int tx_tail = 0;
+
+/* the receive ring, rx_head is the next byte to read */
+static char rx_ring[RX_RING_LEN];
+static unsigned int rx_head = 0;
+static unsigned int rx_tail = 0;
+
+/* whether there is a port, and what the console does with it */
+static int serial_present = 0;
+static int serial_mode = SERIAL_CONSOLE_OFF;
+
+/* whether the transmitter empty interrupt is on */
+static int tx_irq_on = 0;
+
+/** @brief move bytes from the transmit ring to the FIFO, as many as it
+ *         takes if it is empty, and turn the transmitter empty interrupt on
+ *         while there are more. Interrupts disabled
+ *
+ *  @return Void
+ */
+static void serial_tx_fill()
+{
+    int n;
+
+    /* the FIFO still sends what the last fill put in, the interrupt below
+     * comes once it drains
+     */
+    if (inb(UART_LSR) & LSR_THRE) {
+        for (n = 0; n < UART_FIFO_LEN && tx_head != tx_tail; n++) {
+            outb(UART_DATA, tx_ring[tx_head % TX_RING_LEN]);
+            tx_head++;
+        }
+    }
+
+    if (tx_head != tx_tail && !tx_irq_on) {
+        outb(UART_IER, IER_RX | IER_TX);
+        tx_irq_on = 1;
+    }
+    else if (tx_head == tx_tail && tx_irq_on) {
+        outb(UART_IER, IER_RX);
+        tx_irq_on = 0;
+    }
+}
+
+/** @brief put a byte in the transmit ring. When it is full, wait for the
+ *         port to take the oldest byte. Interrupts disabled
+ *
+ *  @param c the byte
+ *  @return Void
+ */
+static void serial_tx_put(char c)
+{
+    while (tx_tail - tx_head == TX_RING_LEN) {
+        while (!(inb(UART_LSR) & LSR_THRE))
+            continue;
+        outb(UART_DATA, tx_ring[tx_head % TX_RING_LEN]);
+        tx_head++;
+    }
+
+    tx_ring[tx_tail % TX_RING_LEN] = c;
+    tx_tail++;
+}
+
+/** @brief handle a serial interrupt
+ *
+ *  @return Void
+ */
+void serial_handler() {
+    report_misc(tag, "SERIAL INTERRUPT");
+
+    int iir, received = 0;
+
+    while (!((iir = inb(UART_IIR)) & IIR_NONE)) {
+        switch (IIR_ID(iir)) {
+            case IIR_RX_DATA:
+            case IIR_RX_TIMEOUT:
+                while (inb(UART_LSR) & LSR_DR) {
+                    char c = inb(UART_DATA);
+
+                    /* drop what does not fit, like the keyboard buffer */
+                    if (rx_tail - rx_head < RX_RING_LEN) {
+                        rx_ring[rx_tail % RX_RING_LEN] = c;
+                        rx_tail++;
+                        received = 1;
+                    }
+                }
+                break;
+
+            case IIR_TX_EMPTY:
+                serial_tx_fill();
+                break;
+
+            case IIR_LINE:
+                inb(UART_LSR);
+                break;
+
+            case IIR_MODEM:
+                inb(UART_MSR);
+                break;
+        }
+    }
+
+    outb(INT_CTL_PORT, INT_ACK_CURRENT);  // tell PIC 'done'
+
+    if (!received)
+        return;
+
+    /* enable interrupts before trying to fill console */
+    enable_interrupts();
+
+    /* feed the line of the foreground terminal if a readline/getchar waits */
+    vterm_t *vt = vt_foreground();
+    if (ldisc_waiting(&(vt->in)))
+        fill_cons(vt);
+}
+
+int serial_init(void *idt_base_p) {
+    int divisor = UART_CLOCK / SERIAL_BAUD;
+
+    /* no port answers with all ones, or forgets the scratch register */
+    outb(UART_SCR, 0x5a);
+    if (inb(UART_LSR) == 0xff || inb(UART_SCR) != 0x5a) {
+        report_warning(tag, "serial_init: no COM1");
+        return -1;
+    }
+
+    outb(UART_IER, 0);
+
+    outb(UART_LCR, LCR_DLAB);
+    outb(UART_DATA, divisor & 0xff);
+    outb(UART_IER, (divisor >> 8) & 0xff);
+    outb(UART_LCR, LCR_8N1);
+
+    outb(UART_FCR, FCR_ENABLE);
+    outb(UART_MCR, MCR_DTR_RTS_OUT2);
+
+    /* clear what is pending */
+    inb(UART_LSR);
+    inb(UART_DATA);
+    inb(UART_IIR);
+    inb(UART_MSR);
+
+    install_desc(idt_base_p, SERIAL_IDT_ENTRY, serial_wrapper,
+                    interrupt_gate, 0);
+
+    outb(UART_IER, IER_RX);
+    outb(PIC_MASTER_IMR, inb(PIC_MASTER_IMR) & ~(1 << SERIAL_IRQ));
+
+    serial_present = 1;
+    serial_mode = SERIAL_CONSOLE_DEFAULT;
+
+    report_progress(tag, "serial_init: COM1 at %d baud", SERIAL_BAUD);
+    return 0;
+}
+
+void serial_write(const char *buf, int len)
+{
+    int i, if_was_set;
+
+    if (!serial_present)
+        return;
+
+    /* a byte at a time with interrupts disabled, so a full ring waits at
+     * most for one byte to go out before the timer gets a chance
+     */
+    for (i = 0; i < len; i++) {
+        if_was_set = if_disable();
+
+        if (buf[i] == '\n')
+            serial_tx_put('\r');
+        serial_tx_put(buf[i]);
+
+        if_recover(if_was_set);
+    }
+
+    if_was_set = if_disable();
+    serial_tx_fill();
+    if_recover(if_was_set);
+}
+
+int serial_readchar(void)
+{
+    int if_was_set = if_disable();
+    char c;
+
+    if (rx_head == rx_tail) {
+        if_recover(if_was_set);
+        return -1;
+    }
+
+    c = rx_ring[rx_head % RX_RING_LEN];
+    rx_head++;
+
+    if_recover(if_was_set);
+
+    if (c == SERIAL_CR)
+        return '\n';
+    if (c == SERIAL_DEL)
+        return '\b';
+    return c;
+}
+
+int serial_console_mode(void)
+{
+    return serial_present ? serial_mode : SERIAL_CONSOLE_OFF;
+}
+
+int serial_set_console_mode(int mode)
+{
+    int old = serial_console_mode();
+
+    if (mode != SERIAL_CONSOLE_OFF && mode != SERIAL_CONSOLE_MIRROR &&
+        mode != SERIAL_CONSOLE_REDIRECT)
+        return -1;
+
+    /* the output would go nowhere */
+    if (!serial_present && mode != SERIAL_CONSOLE_OFF)
+        return -1;
+
+    serial_mode = mode;
+    return old;
+}
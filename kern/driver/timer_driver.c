@@ -19,6 +19,8 @@
 #include <context_switch.h>
 #include <reporter.h>
 #include <frame.h>
+#include <vdso.h>
+#include <console.h>
 
 /* 5 ms period */
 #define TIMER_FREQUENCY 500
@@ -37,6 +39,8 @@ void timer_handler() {
     report_misc(tag, "TIMER INTERRUPT");
 
     tickback_globl(++ticks); 
+    vdso_tick(ticks);
+    console_tick();
 
     outb(INT_CTL_PORT, INT_ACK_CURRENT);  
     
@@ -70,6 +74,7 @@ void timer_init(void *idt_base_p, void (*tickback)(unsigned int)) {
     outb(TIMER_PERIOD_IO_PORT, (CYCLES_BETWEEN_INTERRUPTS >> 8) & 0xFF);
 
     tickback_globl = tickback;
+    vdso_set_tick_usecs(1000000 / TIMER_FREQUENCY);
     install_desc(idt_base_p, TIMER_IDT_ENTRY, timer_wrapper,
                     interrupt_gate, 0);
 }
@@ -0,0 +1,132 @@
+/** @file kern/exec_index.c
+ *
+ *  @brief hashed index of the exec2obj table of contents implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <exec_index.h>
+#include <exec2obj.h>
+#include <string.h>
+#include <malloc.h>
+#include <reporter.h>
+
+static char *tag = "exec_index";
+
+/* the files of the table of contents */
+static exec_entry_t *entries = NULL;
+
+/* open addressing table of entry index + 1, 0 for an empty slot. Its size
+ * is a power of two at least twice the number of files
+ */
+static int *slots = NULL;
+static unsigned long slot_mask = 0;
+
+/** @brief hash a file name (FNV-1a)
+ *
+ *  @param name the file name
+ *  @return the hash
+ */
+static unsigned long exec_index_hash(const char *name)
+{
+    unsigned long h = 2166136261UL;
+
+    while (*name != '\0') {
+        h ^= (unsigned char)*name++;
+        h *= 16777619UL;
+    }
+
+    return h;
+}
+
+int exec_index_init(void)
+{
+    int count = exec2obj_userapp_count;
+    unsigned long size = 16;
+    int i;
+
+    while (size < 2 * (unsigned long)count)
+        size <<= 1;
+
+    if ((entries = calloc(count > 0 ? count : 1, sizeof(exec_entry_t)))
+            == NULL) {
+        report_error(tag, "can't alloc entries");
+        return -1;
+    }
+
+    if ((slots = calloc(size, sizeof(int))) == NULL) {
+        report_error(tag, "can't alloc slots");
+        free(entries);
+        entries = NULL;
+        return -1;
+    }
+
+    slot_mask = size - 1;
+
+    for (i = 0; i < count; i++) {
+        exec_entry_t *e = &entries[i];
+        unsigned long s;
+
+        e->name = exec2obj_userapp_TOC[i].execname;
+        e->bytes = exec2obj_userapp_TOC[i].execbytes;
+        e->len = exec2obj_userapp_TOC[i].execlen;
+        e->hash = exec_index_hash(e->name);
+
+        /* a name listed twice keeps its first entry, like the linear
+         * search did
+         */
+        if (exec_index_lookup(e->name) != NULL)
+            continue;
+
+        for (s = e->hash & slot_mask; slots[s] != 0; s = (s + 1) & slot_mask)
+            continue;
+        slots[s] = i + 1;
+    }
+
+    /* parse every header once, elf_load_helper reads through getbytes,
+     * which uses the index built above
+     */
+    for (i = 0; i < count; i++) {
+        exec_entry_t *e = &entries[i];
+
+        e->is_elf = (elf_check_header(e->name) == ELF_SUCCESS &&
+                     elf_load_helper(&e->elf, e->name) == ELF_SUCCESS);
+    }
+
+    report_progress(tag, "indexed %d files in %d slots", count, (int)size);
+    return 0;
+}
+
+const exec_entry_t *exec_index_lookup(const char *name)
+{
+    unsigned long h;
+    unsigned long s;
+
+    if (slots == NULL || name == NULL)
+        return NULL;
+
+    h = exec_index_hash(name);
+
+    for (s = h & slot_mask; slots[s] != 0; s = (s + 1) & slot_mask) {
+        exec_entry_t *e = &entries[slots[s] - 1];
+
+        if (e->hash == h && strcmp(e->name, name) == 0)
+            return e;
+    }
+
+    return NULL;
+}
+
+int exec_index_read(const exec_entry_t *e, int offset, int size, char *buf)
+{
+    if (offset < 0 || offset > e->len || size < 0)
+        return -1;
+
+    int length = e->len - offset;
+    if (length > size)
+        length = size;
+
+    memcpy(buf, e->bytes + offset, length);
+    return length;
+}
@@ -11,6 +11,9 @@
 #include <mutex.h>
 
 #include <common_include.h>
+#include <reaper.h>
+#include <template.h>
+#include <stack_region.h>
 
 static char *tag = "fault";
 
@@ -61,28 +64,39 @@ void fault_handler(ureg_t *ureg) {
         }
     }
 
-    /* print fault info to console */
-    mutex_lock(&print_mp);
+    /* print fault info to console, after what the thread printed */
+    printq_flush();
+    mutex_lock(&(vt_running()->print_mp));
     print_ureg(ureg);
-    mutex_unlock(&print_mp);
+    mutex_unlock(&(vt_running()->print_mp));
 
     report_warning(tag, "going to kill");
 
     /* set exit status to FAULT_KILL_EXIT_STATUS */
     pcb->exit_status = FAULT_KILL_EXIT_STATUS;
 
+    /* the stack of the thread is free for the next one */
+    stack_region_remove(pcb, tcb->tid);
+
     int process_exited;
     
     /* clean up memory if all threads exited */
     if ((process_exited = 
             (pcb->exited_thread_count == (ht_size(pcb->tcb_ht) - 1)))) {
 
+        /* the terminal it drew on directly goes back to the console */
+        vt_release(pcb->pid);
+
         /* use kern pgd since going to free its own pgd */
         pcb->pgd = (unsigned long)kern_pgd;
         set_cr3((unsigned long)kern_pgd);
 
-        report_progress(tag, "going to cleanup pgd");
-        pgd_process_cleanup(pgd);
+        /* the reaper frees the memory after the parent is signaled */
+        report_progress(tag, "going to queue pgd for teardown");
+        reaper_enqueue(pgd);
+
+        /* nobody else may drop the templates it froze */
+        template_remove_owned(pcb->pid);
         
         mutex_lock(&(pcb->children->mp));
         ht_traverse_all(pcb->children, announce_parent_death);
@@ -105,6 +119,7 @@ void fault_handler(ureg_t *ureg) {
             report_progress(tag, "pcb %p signaling parent %p, exit",
                             pcb, pcb->parent);
             report_error(tag, "signal parent %d", pcb->parent->pid);
+            waitq_wake(&(pcb->parent->child_waitq));
             cond_signal_terminate(&(pcb->parent->wait_cond));
         }
     }
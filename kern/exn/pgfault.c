@@ -7,9 +7,140 @@
  */
 
 #include <common_include.h>
+#include <zswap.h>
+#include <stack_region.h>
 
 static char *tag = "pgfault";
 
+/* page fault error code bits */
+#define PF_PRESENT 0x1
+#define PF_WRITE 0x2
+
+/* COW write faults fault-around saved, in all processes */
+static int faults_saved_all = 0;
+
+/** @brief check if an address is in the text or rodata of a process
+ *
+ *  @param pcb the process
+ *  @param addr the address
+ *  @return 1 if read only, 0 if not
+ */
+static int is_read_only(pcb_t *pcb, unsigned long addr)
+{
+    return (addr >= (unsigned long)pcb->txt_base &&
+            addr < (unsigned long)(pcb->txt_base + pcb->txt_len)) ||
+           (addr >= (unsigned long)pcb->rodat_base &&
+            addr < (unsigned long)(pcb->rodat_base + pcb->rodat_len));
+}
+
+/** @brief resolve a neighbouring COW page ahead of its fault. Only pages
+ *         whose other sharers are gone qualify, they only need to become
+ *         writable again, so nothing is allocated or copied speculatively.
+ *
+ *  @param pcb the process
+ *  @param pgd the pgd of the process, in cr3
+ *  @param addr the page aligned address
+ *  @return 1 if resolved, 0 if the page does not qualify
+ */
+static int fault_around_one(pcb_t *pcb, void *pgd, unsigned long addr)
+{
+    void **pte;
+    void *frm;
+    unsigned long entry;
+    int if_was_set;
+
+    if (addr < USER_MEM_START || addr >= USER_STACK_BASE ||
+        is_read_only(pcb, addr))
+        return 0;
+
+    if ((pte = pgd_get_pte(pgd, (void *)addr)) == NULL)
+        return 0;
+
+    entry = (unsigned long)*pte;
+    if (!PG_IS_PRESENT(entry) || !IS_USER(entry) || IS_WRITABLE(entry) ||
+        (entry & PG_COW) == 0)
+        return 0;
+
+    frm = GET_ADDRESS(entry);
+
+    mutex_lock(&frm_ref_mp);
+
+    if (get_frame_refs(frm) != 1) {
+        mutex_unlock(&frm_ref_mp);
+        return 0;
+    }
+
+    /* the swap clock may have taken the page meanwhile */
+    if_was_set = if_disable();
+    if ((unsigned long)*pte != entry) {
+        if_recover(if_was_set);
+        mutex_unlock(&frm_ref_mp);
+        return 0;
+    }
+    *pte = (void *)((entry | PG_WRITABLE) & ~PG_COW);
+    invalidate_page((void *)addr);
+    if_recover(if_was_set);
+
+    mutex_unlock(&frm_ref_mp);
+
+    PGD_ACCT_ADD(pgd, shared, -1);
+    frame_set_owner(frm, pgd, (void *)addr);
+
+    return 1;
+}
+
+/** @brief after a COW write fault got resolved, resolve the pages ahead
+ *         of it in the direction the process is writing in. The window
+ *         doubles up to FAULT_AROUND_MAX while the faults keep landing
+ *         right past the previous window, and closes on any other fault.
+ *
+ *  @param pcb the process
+ *  @param pgd the pgd of the process, in cr3
+ *  @param fault_addr the faulting address
+ *  @return Void
+ */
+static void fault_around(pcb_t *pcb, void *pgd, unsigned long fault_addr)
+{
+    unsigned long page = (unsigned long)GET_ADDRESS(fault_addr);
+    unsigned long addr;
+    int done;
+
+    if (page == pcb->fault_next && pcb->fault_dir != 0) {
+        /* the stream goes on */
+        pcb->fault_window = (pcb->fault_window == 0) ? 1 : 
+                                pcb->fault_window * 2;
+        if (pcb->fault_window > FAULT_AROUND_MAX)
+            pcb->fault_window = FAULT_AROUND_MAX;
+    }
+    else {
+        /* a new stream, guess its direction from the last fault */
+        pcb->fault_dir = (page < pcb->fault_last) ? -1 : 1;
+        pcb->fault_window = 0;
+    }
+
+    addr = page;
+    for (done = 0; done < pcb->fault_window; done++) {
+        addr += pcb->fault_dir * PAGE_SIZE;
+        if (!fault_around_one(pcb, pgd, addr))
+            break;
+    }
+
+    if (done > 0) {
+        pcb->faults_saved += done;
+        xadd(&faults_saved_all, done);
+        report_progress(tag, "fault_around: resolved %d pages after 0x%x",
+                        done, page);
+    }
+
+    pcb->fault_last = page;
+    pcb->fault_next = page + pcb->fault_dir * (done + 1) * PAGE_SIZE;
+}
+
+int pgfault_get_faults_saved(void)
+{
+    return faults_saved_all;
+}
+
 void pgfault_handler(unsigned long edi, unsigned long esi, unsigned long ebp,
                     unsigned long esp, unsigned long ebx, unsigned long edx,
                     unsigned long ecx, unsigned long eax, 
@@ -42,10 +173,27 @@ void pgfault_handler(unsigned long edi, unsigned long esi, unsigned long ebp,
         fault_handler(&ureg); 
     }
 
-    if ((fault_addr >= (unsigned long)pcb->txt_base &&
-        fault_addr < (unsigned long)(pcb->txt_base + pcb->txt_len)) ||
-        (fault_addr >= (unsigned long)pcb->rodat_base &&
-        fault_addr < (unsigned long)(pcb->rodat_base + pcb->rodat_len))) {
+    /* the page was compressed into the swap pool, bring it back. This goes
+     * before the read only checks, since reading swapped text faults too
+     */
+    if (zswap_is_swapped(pgd, (void *)fault_addr)) {
+        if (zswap_fault_in(pgd, (void *)fault_addr) == 0) {
+            report_progress(tag, "swapped in 0x%x, exit", fault_addr);
+            return;
+        }
+
+        report_error(tag, "fail to swap in");
+
+        ureg_t ureg;
+        ureg_create(&ureg, SWEXN_CAUSE_PAGEFAULT, fault_addr,
+                    fault_ss, fault_ss, fault_ss, fault_ss,
+                    edi, esi, ebp, ebx, edx, ecx, eax, error_code,
+                    fault_eip, fault_cs, fault_eflags, fault_esp,
+                    fault_ss); 
+        fault_handler(&ureg);
+    }
+
+    if (is_read_only(pcb, fault_addr)) {
         report_error(tag, "user tries to write on read only memory");
 
         ureg_t ureg;
@@ -57,6 +205,13 @@ void pgfault_handler(unsigned long edi, unsigned long esi, unsigned long ebp,
         fault_handler(&ureg); 
     }
 
+    /* below the stack of the thread, grow it */
+    if (pgd_get_frm(pgd, (void *)fault_addr) == NULL &&
+        stack_region_grow(pcb, tcb->tid, fault_addr) == 0) {
+        report_progress(tag, "grew stack over 0x%x, exit", fault_addr);
+        return;
+    }
+
     if (pgd_get_frm(pgd, (void *)fault_addr) == NULL) {
         report_warning(tag, "user tries to use unallocated memory");
 
@@ -69,6 +224,12 @@ void pgfault_handler(unsigned long edi, unsigned long esi, unsigned long ebp,
         fault_handler(&ureg); 
     }
     
+    /* a write on a copy-on-write page, the neighbours may follow */
+    void **pte = pgd_get_pte(pgd, (void *)fault_addr);
+    int cow_write = ((error_code & (PF_PRESENT | PF_WRITE)) == 
+                        (PF_PRESENT | PF_WRITE)) &&
+                    pte != NULL && ((unsigned long)*pte & PG_COW);
+
     if (vm_frm_copy(pgd, (void *)fault_addr, 1) != 0) {
         report_error(tag, "fail to COW");
 
@@ -81,6 +242,9 @@ void pgfault_handler(unsigned long edi, unsigned long esi, unsigned long ebp,
         fault_handler(&ureg);
     }
 
+    if (cow_write)
+        fault_around(pcb, pgd, fault_addr);
+
     report_progress(tag, "pgfault handler resolved 0x%x which stores %d", 
                     (int)fault_addr, *(int *)fault_addr);
    
@@ -13,6 +13,19 @@
 #include <mutex.h>
 #include <hash.h>
 #include <reporter.h>
+#include <malloc.h>
+#include <zswap.h>
+#include <reaper.h>
+#include <asm.h>
+
+/* the index of a user frame in frame_owners */
+#define FRAME_INDEX(frm) (((unsigned long)(frm) - USER_MEM_START) >> PAGE_SHIFT)
+
+/* the single mapping of a frame, so the swap clock can find its entry */
+typedef struct frame_owner {
+    void *pgd;
+    void *linear_addr;
+} frame_owner_t;
 
 queue free_frame_queue;
 
@@ -24,6 +37,12 @@ mutex_t frm_mp;
 
 int frame_count;
 
+/* the number of user frames in the machine */
+static int frame_total;
+
+/* the owner of each user frame, indexed by FRAME_INDEX */
+static frame_owner_t *frame_owners;
+
 static char *tag = "frame";
 
 int key_compare_frm(ht_entry_t *e1, ht_entry_t *e2)
@@ -40,6 +59,14 @@ int frame_init() {
     if (frame_count <= 0)
         return -1;
 
+    frame_total = frame_count;
+
+    frame_owners = calloc(frame_total, sizeof(frame_owner_t));
+    if (frame_owners == NULL) {
+        report_error(tag, "cannot alloc frame owner table");
+        return -1;
+    }
+
     free_frame_queue = queue_new();
     if (free_frame_queue == NULL) {
         report_error(tag, "cannot alloc free frame queue");
@@ -147,6 +174,11 @@ void *frame_alloc() {
     void *data = dequeue(free_frame_queue);
     mutex_unlock(&(free_frame_queue->mp));
 
+    if (data == NULL) {
+        report_warning(tag, "no more frames left");
+        return NULL;
+    }
+
     report_progress(tag, "frame_alloc: going to alloc %p", data);
     
     mutex_lock(&(allocated_frame_ht->mp));
@@ -156,13 +188,33 @@ void *frame_alloc() {
     ht_insert(allocated_frame_ht, (hash_key)data, (hash_value)1);
     mutex_unlock(&(allocated_frame_ht->mp));
 
-    if (data == NULL) {
-        report_error(tag, "no more frames left");
+    xadd(&frame_count, -1);
+
+    return data;
+}
+
+void *frame_alloc_reclaim() {
+    void *frm;
+
+    mutex_lock(&(frm_mp));
+    frm = frame_alloc();
+    mutex_unlock(&(frm_mp));
+
+    /* out of frames, finish the teardown of exited processes first */
+    if (frm == NULL && reaper_drain() > 0) {
+        mutex_lock(&(frm_mp));
+        frm = frame_alloc();
+        mutex_unlock(&(frm_mp));
     }
 
-    frame_count--;
+    /* still out of frames, compress cold pages into the swap pool */
+    if (frm == NULL && zswap_reclaim(ZSWAP_RECLAIM_BATCH) > 0) {
+        mutex_lock(&(frm_mp));
+        frm = frame_alloc();
+        mutex_unlock(&(frm_mp));
+    }
 
-    return data;
+    return frm;
 }
 
 void frame_free(void *frame) {
@@ -187,11 +239,96 @@ void frame_free(void *frame) {
 
     mutex_unlock(&(allocated_frame_ht->mp));
 
-    frame_count++;
+    frame_owners[FRAME_INDEX(frame)].pgd = NULL;
+
+    xadd(&frame_count, 1);
 
     return;
 }
 
+int frame_release_batch(void **frames, int count, void *pgd) {
+    int i;
+    int refs;
+    int freed = 0;
+
+    mutex_lock(&(frm_ref_mp));
+    mutex_lock(&(frm_mp));
+    mutex_lock(&(allocated_frame_ht->mp));
+
+    for (i = 0; i < count; i++) {
+        refs = (int)ht_lookup(allocated_frame_ht, (hash_key)frames[i]);
+
+        if (refs <= 0) {
+            report_error(tag, "frame_release_batch: no refs for frame %p", 
+                         frames[i]);
+            continue;
+        }
+
+        /* still shared, the same key with a new value updates in place */
+        if (refs > 1) {
+            ht_insert(allocated_frame_ht, (hash_key)frames[i], 
+                      (hash_value)(refs - 1));
+            frame_clear_owner(frames[i], pgd);
+            continue;
+        }
+
+        ht_delete(allocated_frame_ht, (hash_key)frames[i]);
+        frame_owners[FRAME_INDEX(frames[i])].pgd = NULL;
+
+        /* keep the frames to free at the front */
+        frames[freed++] = frames[i];
+    }
+
+    mutex_unlock(&(allocated_frame_ht->mp));
+
+    mutex_lock(&(free_frame_queue->mp));
+    for (i = 0; i < freed; i++)
+        enqueue(frames[i], free_frame_queue);
+    mutex_unlock(&(free_frame_queue->mp));
+
+    mutex_unlock(&(frm_mp));
+    mutex_unlock(&(frm_ref_mp));
+
+    xadd(&frame_count, freed);
+
+    report_progress(tag, "frame_release_batch: freed %d of %d frames", 
+                    freed, count);
+
+    return freed;
+}
+
 int frame_get_count() {
     return frame_count;
 }
+
+int frame_get_total() {
+    return frame_total;
+}
+
+void *frame_by_index(int index) {
+    return (void *)(USER_MEM_START + (index * PAGE_SIZE));
+}
+
+void frame_set_owner(void *frame, void *pgd, void *linear_addr) {
+    frame_owner_t *owner = &frame_owners[FRAME_INDEX(frame)];
+
+    owner->pgd = pgd;
+    owner->linear_addr = linear_addr;
+}
+
+void frame_clear_owner(void *frame, void *pgd) {
+    frame_owner_t *owner = &frame_owners[FRAME_INDEX(frame)];
+
+    if (owner->pgd == pgd) {
+        owner->pgd = NULL;
+    }
+}
+
+int frame_get_owner(void *frame, void **pgd, void **linear_addr) {
+    frame_owner_t *owner = &frame_owners[FRAME_INDEX(frame)];
+
+    *pgd = owner->pgd;
+    *linear_addr = owner->linear_addr;
+
+    return (*pgd == NULL) ? -1 : 0;
+}
@@ -42,6 +42,30 @@ unsigned long get_ebp();
  */
 void set_ebp_and_switch(unsigned long ebp);
 
+/**
+ * @brief read the time stamp counter
+ *
+ * @return the current time stamp counter
+ */
+unsigned long long get_tsc();
+
+/**
+ * @brief invalidate the TLB entry of a linear address
+ *
+ * @param addr the linear address
+ * @return Void
+ */
+void invalidate_page(void *addr);
+
+/**
+ * @brief write a model specific register, the high 32 bits become 0
+ *
+ * @param msr the register number
+ * @param value the low 32 bits
+ * @return Void
+ */
+void set_msr(unsigned int msr, unsigned long value);
+
 /**
  * @brief assembly HLT
  *
@@ -23,6 +23,7 @@
 #include <x86/idt.h>
 
 #include <console.h>
+#include <printq.h>
 #include <driver.h>
 #include <ureg.h>
 
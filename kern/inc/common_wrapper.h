@@ -158,4 +158,118 @@ void readfile_wrapper();
  */
 void swexn_wrapper();
 
+/** @brief the set_mem_limit trap handler wrapper 
+ *
+ *  @return Void
+ */
+void set_mem_limit_wrapper();
+
+/** @brief the get_mem_usage trap handler wrapper 
+ *
+ *  @return Void
+ */
+void get_mem_usage_wrapper();
+
+/** @brief the stack_region trap handler wrapper 
+ *
+ *  @return Void
+ */
+void stack_region_wrapper();
+
+/** @brief the spawn trap handler wrapper 
+ *
+ *  @return Void
+ */
+void spawn_wrapper();
+
+/** @brief the template_freeze trap handler wrapper 
+ *
+ *  @return Void
+ */
+void template_freeze_wrapper();
+
+/** @brief the template_spawn trap handler wrapper 
+ *
+ *  @return Void
+ */
+void template_spawn_wrapper();
+
+/** @brief the template_drop trap handler wrapper 
+ *
+ *  @return Void
+ */
+void template_drop_wrapper();
+
+/** @brief the SYSENTER entry, it dispatches on the syscall number in eax
+ *
+ *  @return Void
+ */
+void sysenter_wrapper();
+
+/** @brief the ring_setup trap handler wrapper 
+ *
+ *  @return Void
+ */
+void ring_setup_wrapper();
+
+/** @brief the ring_enter trap handler wrapper 
+ *
+ *  @return Void
+ */
+void ring_enter_wrapper();
+
+/** @brief the futex_wait trap handler wrapper 
+ *
+ *  @return Void
+ */
+void futex_wait_wrapper();
+
+/** @brief the futex_wake trap handler wrapper 
+ *
+ *  @return Void
+ */
+void futex_wake_wrapper();
+
+/** @brief the syscall_stats trap handler wrapper 
+ *
+ *  @return Void
+ */
+void syscall_stats_wrapper();
+
+/** @brief the console_mode trap handler wrapper 
+ *
+ *  @return Void
+ */
+void console_mode_wrapper();
+
+/** @brief the set_vterm trap handler wrapper 
+ *
+ *  @return Void
+ */
+void set_vterm_wrapper();
+
+/** @brief the blit_cells trap handler wrapper 
+ *
+ *  @return Void
+ */
+void blit_cells_wrapper();
+
+/** @brief the console_map trap handler wrapper 
+ *
+ *  @return Void
+ */
+void console_map_wrapper();
+
+/** @brief the poll trap handler wrapper 
+ *
+ *  @return Void
+ */
+void poll_wrapper();
+
+/** @brief the print_flush trap handler wrapper 
+ *
+ *  @return Void
+ */
+void print_flush_wrapper();
+
 #endif /* !_COMMON_WRAPPER_H */
@@ -9,15 +9,61 @@
 #ifndef _KERN_INC_CONSOLE_H_
 #define _KERN_INC_CONSOLE_H_
 
-#include <circ_buf.h>
-#include <queue.h>
+#include <ldisc.h>
 #include <cond.h>
+#include <mutex.h>
+#include <stdint.h>
+#include <x86/video_defines.h>
+#include <syscall_ext.h>
 
-/* the console buffer (for readline syscall) */
-extern circ_buf_t cons_buf;
+/* the most parameters of an ANSI escape sequence kept, the rest are
+ * ignored
+ */
+#define VT_ESC_PARAMS 4
+
+/* a virtual terminal: the screen, cursor and color the processes on it
+ * print to, and the input line they read from
+ */
+typedef struct vterm {
+    /* the screen, a page of its own, its row first is the top row.
+     * Scrolling moves first, unless the page is mapped
+     */
+    uint16_t *cells;
+    int first;
+
+    /* the process the page is mapped into (console_map), 0 if none */
+    int owner;
+
+    /* the rows video memory is behind on, and the rows scrolled since the
+     * last flush. Only the foreground terminal gets flushed
+     */
+    uint32_t dirty_rows;
+    int scroll_pending;
+
+    /* the threads in the middle of changing the terminal */
+    volatile int writers;
 
-/* a queue of conditional variables that readline uses */
-extern queue cons_cond_queue;
+    int cursor_row;
+    int cursor_col;
+    int cursor_is_visible;
+    int term_color;
+
+    /* the ANSI escape sequence being parsed, it may go on in the next
+     * print, and the cursor ESC [ s saved
+     */
+    int esc_state;
+    int esc_private;
+    int esc_nparams;
+    int esc_params[VT_ESC_PARAMS];
+    int saved_row;
+    int saved_col;
+
+    /* keeps the prints on the terminal whole */
+    mutex_t print_mp;
+
+    /* the input lines, and the readlines and getchars waiting on them */
+    ldisc_t in;
+} vterm_t;
 
 /** @brief init the console
  *
@@ -25,6 +71,83 @@ extern queue cons_cond_queue;
  */
 int cons_init();
 
+/** @brief the terminal of the running process, the first one before there
+ *         is a process
+ *
+ *  @return the terminal
+ */
+vterm_t *vt_running();
+
+/** @brief the terminal on the screen, the one the keyboard types into
+ *
+ *  @return the terminal
+ */
+vterm_t *vt_foreground();
+
+/** @brief a terminal by index
+ *
+ *  @param idx the index, 0 to NVTERMS - 1
+ *  @return the terminal, NULL if idx is invalid
+ */
+vterm_t *vt_get(int idx);
+
+/** @brief ask for a terminal to be brought to the screen, by the next
+ *         timer tick or console call that finds the console free. Safe in
+ *         an interrupt handler, it takes no lock
+ *
+ *  @param idx the index, 0 to NVTERMS - 1
+ *  @return 0 on success, -1 if idx is invalid
+ */
+int vt_switch(int idx);
+
+/** @brief give a process the cells of a terminal to write to directly:
+ *         they become plain rows, top row first, and every flush copies
+ *         them all
+ *
+ *  @param vt the terminal
+ *  @param pid the process
+ *  @return 0 on success, -1 if another process has them
+ */
+int vt_map(vterm_t *vt, int pid);
+
+/** @brief take back the terminals a process has the cells of, when it
+ *         unmaps them, execs or exits
+ *
+ *  @param pid the process
+ *  @return the terminals taken back
+ */
+int vt_release(int pid);
+
+/** @brief copy a rectangle of cells (character and color) to a terminal
+ *
+ *  @param vt the terminal
+ *  @param row the top row
+ *  @param col the left column
+ *  @param w the columns
+ *  @param h the rows
+ *  @param cells the h rows of w cells
+ *  @return 0 on success, -1 if the rectangle is not on the screen
+ */
+int vt_blit(vterm_t *vt, int row, int col, int w, int h,
+            const uint16_t *cells);
+
+/** @brief putbyte on a given terminal
+ *
+ *  @param vt the terminal
+ *  @param ch the character to print
+ *  @return The input character
+ */
+int vt_putbyte(vterm_t *vt, char ch);
+
+/** @brief putbytes on a given terminal
+ *
+ *  @param vt the terminal
+ *  @param s the string to be printed
+ *  @param len the length of the string s
+ *  @return Void
+ */
+void vt_putbytes(vterm_t *vt, const char *s, int len);
+
 /** @brief Prints character ch at the current location
  *         of the cursor.
  *
@@ -151,4 +274,23 @@ void draw_char(int row, int col, int ch, int color);
  */
 char get_char(int row, int col);
 
+/** @brief Copies what changed on the console since the last flush to the
+ *         screen, unless a thread is in the middle of changing it.
+ *
+ *  Called by the timer interrupt handler.
+ *
+ *  @return Void.
+ */
+void console_tick();
+
+/** @brief Chooses when the console gets flushed to the screen.
+ *
+ *  In CONSOLE_MODE_SYNC every console call flushes before it returns, in
+ *  CONSOLE_MODE_DEFERRED console_tick does.
+ *
+ *  @param mode CONSOLE_MODE_SYNC or CONSOLE_MODE_DEFERRED.
+ *  @return The mode before, or -1 if mode is invalid.
+ */
+int console_set_mode(int mode);
+
 #endif /* _KERN_INC_CONSOLE_H_ */
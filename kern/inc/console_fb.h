@@ -0,0 +1,40 @@
+/** @file kern/inc/console_fb.h
+ *
+ *  @brief the text framebuffer a process can map
+ *
+ *  The cells of every virtual terminal are a page of their own. Each
+ *  terminal has a page table mapping its page at CONSOLE_FB_ADDR, and
+ *  console_map puts the one of the caller's terminal in the caller's pgd,
+ *  the way the vdso page table is shared. The user page walks skip the
+ *  entry and fork does not copy it: the mapping belongs to the process
+ *  that owns the terminal (vt_map).
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_CONSOLE_FB_H_
+#define _KERN_INC_CONSOLE_FB_H_
+
+#include <syscall_ext.h>
+
+/* the pgd entry of the framebuffer */
+#define CONSOLE_FB_PGD_INDEX (CONSOLE_FB_ADDR >> 22)
+
+/** @brief map the cells of a terminal writable at CONSOLE_FB_ADDR
+ *
+ *  @param pgd the pgd of the owner
+ *  @param idx the index of the terminal
+ *  @param cells the page of its cells
+ *  @return Void
+ */
+void console_fb_map(void *pgd, int idx, void *cells);
+
+/** @brief take the framebuffer out of a pgd
+ *
+ *  @param pgd the pgd
+ *  @return Void
+ */
+void console_fb_unmap(void *pgd);
+
+#endif
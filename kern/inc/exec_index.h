@@ -0,0 +1,61 @@
+/** @file kern/inc/exec_index.h
+ *
+ *  @brief hashed index of the exec2obj table of contents
+ *
+ *  The table of contents never changes after boot, so it is indexed once
+ *  by an open addressing hash table, and the ELF header of every program
+ *  in it is parsed once. exec and readfile then find a file by one hash
+ *  probe (plus a single compare to confirm the hit) instead of a strcmp
+ *  per entry, and exec no longer re-parses the ELF header.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_EXEC_INDEX_H_
+#define _KERN_INC_EXEC_INDEX_H_
+
+#include <elf_410.h>
+
+/* a file of the table of contents */
+typedef struct exec_entry {
+    /* the file, straight from exec2obj_userapp_TOC */
+    const char *name;
+    const char *bytes;
+    int len;
+
+    /* the full hash of the name */
+    unsigned long hash;
+
+    /* 1 if the file is an ELF program and elf holds its parsed header */
+    int is_elf;
+
+    /* the entry point and segment layout of the program */
+    simple_elf_t elf;
+} exec_entry_t;
+
+/** @brief build the index and parse the ELF headers, before the first
+ *         program is loaded
+ *
+ *  @return 0 on success, -1 on error
+ */
+int exec_index_init(void);
+
+/** @brief find a file by name
+ *
+ *  @param name the file name
+ *  @return the entry, NULL if there is no such file
+ */
+const exec_entry_t *exec_index_lookup(const char *name);
+
+/** @brief copy bytes of a file into a buffer
+ *
+ *  @param e the file
+ *  @param offset where in the file to start
+ *  @param size the most bytes to copy
+ *  @param buf the buffer
+ *  @return the number of bytes copied, -1 if offset is out of the file
+ */
+int exec_index_read(const exec_entry_t *e, int offset, int size, char *buf);
+
+#endif
@@ -40,6 +40,14 @@ void *frame_kern_init(void);
  */
 void *frame_alloc(void);
 
+/** @brief allocate a frame. If free_frame_queue ran dry, first finish the
+ *         queued teardowns, then compress cold pages into the swap pool.
+ *         Takes frm_mp itself.
+ *
+ *  @return the frame on success, NULL if no frame can be found
+ */
+void *frame_alloc_reclaim(void);
+
 /** @brief free a frame and put it inside free_frame_queue
  *
  *  @param frame the frame we want to free
@@ -47,6 +55,21 @@ void *frame_alloc(void);
  */
 void frame_free(void *frame);
 
+/* the most frames handed to frame_release_batch at once */
+#define FRAME_RELEASE_BATCH 32
+
+/** @brief drop one reference (COW) from each of a batch of frames mapped by
+ *         pgd, and free the frames whose last reference went away. The
+ *         frame locks are taken once for the whole batch. Takes frm_ref_mp
+ *         and frm_mp itself.
+ *
+ *  @param frames the frames, the array is reused as scratch space
+ *  @param count the number of frames, at most FRAME_RELEASE_BATCH
+ *  @param pgd the pgd the frames are unmapped from
+ *  @return the number of frames freed
+ */
+int frame_release_batch(void **frames, int count, void *pgd);
+
 /** @brief get the reference count (COW) of a frame
  *
  *  @param frame the frame we want to check
@@ -68,4 +91,44 @@ int set_frame_refs(void *frame, int refs);
  */
 int frame_get_count();
 
+/** @brief get the number of user frames in the machine
+ *
+ *  @return the number of user frames
+ */
+int frame_get_total();
+
+/** @brief get a user frame by its index
+ *
+ *  @param index the index of the frame, from 0 to frame_get_total() - 1
+ *  @return the frame
+ */
+void *frame_by_index(int index);
+
+/** @brief record the pgd and linear address that solely map a frame
+ *
+ *  @param frame the frame
+ *  @param pgd the pgd mapping the frame
+ *  @param linear_addr the linear address the frame is mapped at
+ *  @return Void
+ */
+void frame_set_owner(void *frame, void *pgd, void *linear_addr);
+
+/** @brief forget the owner of a frame if it is pgd
+ *
+ *  @param frame the frame
+ *  @param pgd the pgd that no longer maps the frame
+ *  @return Void
+ */
+void frame_clear_owner(void *frame, void *pgd);
+
+/** @brief get the recorded owner of a frame. The owner is only a hint, the
+ *         caller has to check the entry still maps the frame.
+ *
+ *  @param frame the frame
+ *  @param pgd where to store the pgd
+ *  @param linear_addr where to store the linear address
+ *  @return 0 if the frame has an owner, -1 if not
+ */
+int frame_get_owner(void *frame, void **pgd, void **linear_addr);
+
 #endif
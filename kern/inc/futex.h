@@ -0,0 +1,88 @@
+/** @file kern/inc/futex.h
+ *
+ *  @brief futex wait queues
+ *
+ *  Threads blocked in futex_wait hang in a hash of wait queues keyed by
+ *  the physical address of the word, so the key does not depend on the
+ *  address space it is reached through: processes forked from each other
+ *  meet on the frames they still share. When a copy-on-write fault gives
+ *  one of them a private copy, vm_frm_copy moves the waiters of that
+ *  address space over to the new frame, and the swap clock leaves frames
+ *  with waiters alone. A timeout puts the thread in the sleep queue as
+ *  well, whichever of the two lets go of it first takes it out of the
+ *  other one. Everything is done with interrupts disabled, like the
+ *  scheduler queues.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_FUTEX_H_
+#define _KERN_INC_FUTEX_H_
+
+#include <kthread_pool.h>
+
+/* the number of wait queues, a power of 2 */
+#define FUTEX_BUCKETS 64
+
+/* a thread blocked in futex_wait, it lives on its kernel stack */
+typedef struct futex_waiter {
+    /* the physical address of the word */
+    unsigned long key;
+
+    /* the blocked thread and its address space */
+    ktcb_t *ktcb;
+    void *pgd;
+
+    /* set by futex_wake */
+    int woken;
+
+    /* if the thread is in the sleep queue too */
+    int timed;
+
+    struct futex_waiter *next;
+} futex_waiter_t;
+
+/** @brief block the running thread while a user word holds a value
+ *
+ *  @param addr the user address of the word
+ *  @param expected the value to block on
+ *  @param timeout the most ticks to block, 0 for no limit
+ *  @return 0 when woken, FUTEX_EAGAIN if the word did not hold expected,
+ *          FUTEX_ETIMEDOUT on timeout, -1 on error
+ */
+int futex_wait(int *addr, int expected, int timeout);
+
+/** @brief wake threads blocked on a user word, the longest waiting first
+ *
+ *  @param addr the user address of the word
+ *  @param n the most threads to wake
+ *  @return the threads woken, -1 on error
+ */
+int futex_wake(int *addr, int n);
+
+/** @brief take a thread that is being killed out of its wait queue
+ *
+ *  @param ktcb the kernel thread
+ *  @return 1 if it was blocked in futex_wait, 0 if not
+ */
+int futex_cancel(ktcb_t *ktcb);
+
+/** @brief move the waiters of an address space to the private copy of a
+ *         frame, interrupts disabled
+ *
+ *  @param pgd the address space that got the copy
+ *  @param old_frm the shared frame
+ *  @param new_frm the private copy
+ *  @return Void
+ */
+void futex_rekey(void *pgd, void *old_frm, void *new_frm);
+
+/** @brief check if a frame has waiters, interrupts disabled
+ *
+ *  @param frm the frame
+ *  @return 1 if it does, 0 if not
+ */
+int futex_frame_busy(void *frm);
+
+#endif
@@ -22,6 +22,9 @@
 /* the initial kernel pool size */
 #define KTHREAD_POOL_SIZE 10
 
+/* the futex waiter type declaration (see futex.h) */
+struct futex_waiter;
+
 /* the kernel thread struct */
 typedef struct ktcb {
     /* the registers of this kernel thread */
@@ -45,6 +48,9 @@ typedef struct ktcb {
 
     /* the mutex that this kernel thread is blocking on */
     mutex_t *blocked_mutex;
+
+    /* the futex wait this kernel thread is blocked in (see futex.h) */
+    struct futex_waiter *futex_w;
 } ktcb_t;
 
 /** @brief init the kernel threads pool
@@ -0,0 +1,98 @@
+/** @file kern/inc/ldisc.h
+ *
+ *  @brief the line discipline of a terminal's input
+ *
+ *  Typed characters go into a ring: the line being typed sits after the
+ *  completed ones and backspace only erases in it. The completed lines end
+ *  at edit, so whether there is one to read is head != edit, no scan.
+ *  Readers (readline and getchar) wait in one FIFO queue, and only the
+ *  oldest one reads: a completed line goes to it, and it passes what it
+ *  leaves behind to the next one. The head reader copies out of the ring
+ *  with interrupts enabled, the producer never goes below edit and the
+ *  head reader is the only one that moves head.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_LDISC_H_
+#define _KERN_INC_LDISC_H_
+
+#include <waitq.h>
+
+/* the length of the input ring, a power of 2 */
+#define LDISC_BUF_LEN 4096
+
+/* declare ktcb type */
+struct ktcb;
+
+/* a thread waiting to read, it lives on its kernel stack */
+typedef struct ldisc_waiter {
+    struct ktcb *ktcb;
+
+    /* set when it is made runnable, so it is only made runnable once */
+    int woken;
+
+    struct ldisc_waiter *next;
+} ldisc_waiter_t;
+
+/* line discipline struct definition */
+typedef struct ldisc {
+    char *buf;
+
+    /* the next byte to read, the end of the completed lines and the end of
+     * the line being typed. They run free and are masked into buf
+     */
+    unsigned int head;
+    unsigned int edit;
+    unsigned int tail;
+
+    /* the readers, the oldest first */
+    ldisc_waiter_t *waiters;
+    ldisc_waiter_t **waiters_tail;
+
+    /* the polls waiting for a completed line */
+    waitq_t pollers;
+} ldisc_t;
+
+/** @brief init a line discipline
+ *
+ *  @param ld the pointer to the ldisc struct
+ *  @return 0 on success, -1 on error
+ */
+int ldisc_init(ldisc_t *ld);
+
+/** @brief take a typed character: '\b' erases the last one of the line
+ *         being typed, '\n' completes it and wakes the oldest reader
+ *
+ *  @param ld the pointer to the ldisc struct
+ *  @param c the character
+ *  @return 0 if it was taken (and should be echoed), -1 if not
+ */
+int ldisc_input(ldisc_t *ld, char c);
+
+/** @brief whether a reader or a poll is waiting
+ *
+ *  @param ld the pointer to the ldisc struct
+ *  @return 1 if one is, 0 if not
+ */
+int ldisc_waiting(ldisc_t *ld);
+
+/** @brief whether there is a completed line to read
+ *
+ *  @param ld the pointer to the ldisc struct
+ *  @return 1 if there is, 0 if not
+ */
+int ldisc_readable(ldisc_t *ld);
+
+/** @brief wait for its turn and a completed line, then read up to len bytes
+ *         of it, the '\n' included
+ *
+ *  @param ld the pointer to the ldisc struct
+ *  @param buf where to copy the bytes
+ *  @param len the most bytes to copy, more than 0
+ *  @return the bytes copied
+ */
+int ldisc_read(ldisc_t *ld, char *buf, int len);
+
+#endif
@@ -0,0 +1,53 @@
+/** @file kern/inc/lz.h
+ *
+ *  @brief a small LZ77 (LZRW1 style) compressor for page sized buffers
+ *
+ *  The compressed stream is a sequence of groups. Each group starts with a
+ *  16-bit control word, one bit per item, followed by up to LZ_GROUP items.
+ *  A clear bit is a literal byte, a set bit is a two byte copy item holding
+ *  a 12-bit offset and a 4-bit length.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_LZ_H_
+#define _KERN_INC_LZ_H_
+
+/* items per control word */
+#define LZ_GROUP 16
+
+/* copy items cover 3 to 18 bytes, at most 4095 bytes back */
+#define LZ_MIN_MATCH 3
+#define LZ_MAX_MATCH (LZ_MIN_MATCH + 15)
+#define LZ_MAX_OFFSET 4095
+
+/* entries of the match finder table */
+#define LZ_HASH_BITS 12
+#define LZ_TABLE_SIZE (1 << LZ_HASH_BITS)
+
+/** @brief compress a buffer
+ *
+ *  @param src the buffer to compress, at most LZ_MAX_OFFSET + 1 bytes
+ *  @param src_len the length of src
+ *  @param dst where to put the compressed stream
+ *  @param dst_cap the capacity of dst
+ *  @param table scratch space of LZ_TABLE_SIZE entries for the match finder
+ *  @return the compressed length on success, -1 if it does not fit in dst
+ */
+int lz_compress(const unsigned char *src, int src_len,
+                unsigned char *dst, int dst_cap, unsigned short *table);
+
+/** @brief decompress a buffer made by lz_compress
+ *
+ *  @param src the compressed stream
+ *  @param src_len the length of src
+ *  @param dst where to put the original data
+ *  @param dst_cap the capacity of dst
+ *  @return the decompressed length on success, -1 if src is corrupted or
+ *          does not fit in dst
+ */
+int lz_decompress(const unsigned char *src, int src_len,
+                  unsigned char *dst, int dst_cap);
+
+#endif
@@ -0,0 +1,55 @@
+/** @file kern/inc/mpsc_queue.h
+ *  @brief header file for the multi producer, single consumer queue
+ *
+ *  An intrusive linked queue: any number of threads push without a lock
+ *  (one xchg of the tail, then a link), one thread pops. A producer that
+ *  got switched away between the two leaves the queue looking empty past
+ *  its node until it runs again, the consumer just tries later.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_MPSC_QUEUE_H_
+#define _KERN_INC_MPSC_QUEUE_H_
+
+/* the link, put it in the struct queued */
+typedef struct mpsc_node {
+    struct mpsc_node * volatile next;
+} mpsc_node_t;
+
+/* mpsc queue struct definition */
+typedef struct mpsc_queue {
+    /* the last node pushed, only producers write it */
+    mpsc_node_t * volatile tail;
+
+    /* the next node to pop, only the consumer writes it */
+    mpsc_node_t *head;
+
+    /* keeps the queue from ever being without a node */
+    mpsc_node_t stub;
+} mpsc_queue_t;
+
+/** @brief init a mpsc queue
+ *
+ *  @param q the pointer to the queue struct
+ *  @return Void
+ */
+void mpsc_init(mpsc_queue_t *q);
+
+/** @brief push a node, from any thread
+ *
+ *  @param q the pointer to the queue struct
+ *  @param n the node
+ *  @return Void
+ */
+void mpsc_push(mpsc_queue_t *q, mpsc_node_t *n);
+
+/** @brief pop the oldest node, consumer only
+ *
+ *  @param q the pointer to the queue struct
+ *  @return the node, NULL if the queue is empty (or a push is halfway)
+ */
+mpsc_node_t *mpsc_pop(mpsc_queue_t *q);
+
+#endif
@@ -14,6 +14,8 @@
 #include <reg.h>
 #include <cond.h>
 #include <mutex.h>
+#include <syscall_stats.h>
+#include <waitq.h>
 
 /* the pid_t declaration */
 typedef int pid_t;
@@ -24,6 +26,9 @@ typedef struct pcb pcb_t;
 /* the ktcb type declaration */
 struct ktcb;
 
+/* the stack region type declaration (see stack_region.h) */
+struct stack_region;
+
 /* the process control block struct */
 struct pcb {
     /* process id */
@@ -51,8 +56,9 @@ struct pcb {
 
     int exit_status;
 
-    /* for wait system call */
+    /* for wait system call, and the polls waiting for a child */
     cond_t wait_cond;
+    waitq_t child_waitq;
     
     /* track read only memory regions */
     void *txt_base;
@@ -61,6 +67,32 @@ struct pcb {
     int rodat_len;
 
     int exited_thread_count;
+
+    /* the virtual terminal it prints to and reads from (console.c) */
+    int vt;
+
+    /* sequential COW write fault detector for fault-around (pgfault.c) */
+    unsigned long fault_last;
+    unsigned long fault_next;
+    int fault_dir;
+    int fault_window;
+
+    /* COW write faults that fault-around made unnecessary */
+    int faults_saved;
+
+    /* grow-down stacks the threads registered */
+    struct stack_region *stack_regions;
+    mutex_t stack_mp;
+
+    /* the submission/completion ring registered by ring_setup */
+    void *ring;
+    int ring_entries;
+    mutex_t ring_mp;
+
+#if SYSCALL_STATS_ENABLED
+    /* the syscalls of the process, by SYS_ number (syscall_stats.c) */
+    syscall_stat_t sys_stats[SYSCALL_STAT_NSYS];
+#endif
 };
 
 /** @brief generate a tid
@@ -40,4 +40,14 @@ void pgfault_handler(unsigned long edi, unsigned long esi, unsigned long ebp,
                     unsigned long fault_cs, unsigned long fault_eflags,
                     unsigned long fault_esp, unsigned long fault_ss); 
 
+/* the most neighbouring pages resolved along with one COW write fault */
+#define FAULT_AROUND_MAX 16
+
+/** @brief get the number of COW write faults fault-around saved in all
+ *         processes
+ *
+ *  @return the number of faults saved
+ */
+int pgfault_get_faults_saved(void);
+
 #endif
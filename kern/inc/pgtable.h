@@ -15,6 +15,7 @@
 #include <syscall.h>
 #include <malloc.h>
 #include <string.h>
+#include <asm.h>
 
 /* the page size shift */
 #define PAGE_SHIFT 12
@@ -28,13 +29,32 @@
 /* Flag Bit 2 */
 #define PG_USER 0b100
 #define PG_SUPERVISOR (~0b100)
+/* Flag Bit 5, set by hardware when the page is accessed */
+#define PG_ACCESSED 0b100000
+/* Flag Bit 6, set by hardware when the page is written */
+#define PG_DIRTY 0b1000000
 /* Flag Bit 8, cr4's PGE needs to be set */
 #define PG_PREVENT_MAPPING_FLUSHED 0b100000000
+/* Flag Bit 9 (available to software), non-present entry is a swap entry */
+#define PG_SWAPPED 0b1000000000
+/* Flag Bit 10 (available to software), page is shared copy-on-write */
+#define PG_COW 0b10000000000
 
 /* check if the bit is on in flags */
 #define IS_PRESENT(flags) (int)((flags & PG_PRESENT))
 #define IS_WRITABLE(flags) (int)((flags & PG_WRITABLE) >> 1)
 #define IS_USER(flags) (int)((flags & PG_USER) >> 2)
+#define IS_ACCESSED(flags) (int)((flags & PG_ACCESSED) >> 5)
+
+/* swap entries keep the pool slot in the address bits, and the writable and
+ * user bits of the page they replaced
+ */
+#define IS_SWAPPED(entry) (!PG_IS_PRESENT(entry) && \
+                           ((unsigned long)(entry) & PG_SWAPPED))
+#define SWAP_ENTRY(slot, flags) \
+    ((void *)(((unsigned long)(slot) << PAGE_SHIFT) | \
+              ((unsigned long)(flags) & (PG_WRITABLE | PG_USER)) | PG_SWAPPED))
+#define SWAP_SLOT(entry) ((int)((unsigned long)(entry) >> PAGE_SHIFT))
 
 /* discard least 12 bits */
 #define GET_ADDRESS(x) ((void *)((unsigned long)(x) & ~0b111111111111))
@@ -49,6 +69,42 @@
 #define GET_LINEAR_ADDR(pgd, pte) ((void *)(((unsigned long)(pgd) << 22) | \
                                             ((unsigned long)(pte) << 12)))
 
+/* the accounting of an address space. It sits right after the pgd page,
+ * so it is allocated and freed with the pgd and follows it through fork
+ * and exec.
+ */
+typedef struct vm_acct {
+    /* present user pages */
+    int resident;
+
+    /* present user pages mapped copy-on-write (PG_COW) */
+    int shared;
+
+    /* user pages compressed into the swap pool */
+    int swapped;
+
+    /* page tables of the user region */
+    int pt_pages;
+
+    /* most private (resident - shared) frames allowed, 0 for no limit */
+    int max_frames;
+
+    /* set once the pgd is queued for teardown, the swap clock skips it */
+    int dying;
+
+    /* the next pgd in the teardown queue (see reaper.c) */
+    void *reap_next;
+} vm_acct_t;
+
+/* the size to allocate and free a pgd with */
+#define PGD_ALLOC_SIZE (PAGE_SIZE + sizeof(vm_acct_t))
+
+/* the accounting of a pgd */
+#define PGD_ACCT(pgd) ((vm_acct_t *)((char *)(pgd) + PAGE_SIZE))
+
+/* atomically adjust one counter of the accounting of a pgd */
+#define PGD_ACCT_ADD(pgd, field, n) xadd(&(PGD_ACCT(pgd)->field), (n))
+
 /** @brief allocate a pgd
  *
  *  @return the pointer to pgd on success, NULL on error
@@ -67,7 +123,25 @@ void *pgd_alloc(void);
 int pgd_insert(void *pgd, void *linear_addr, unsigned long pt_flags,
                unsigned long frm_flags, void *phy_frame);
 
-/** @brief allocate frames for a range of linear address
+/** @brief check if the limit of a pgd allows more private frames
+ *
+ *  @param pgd the pgd
+ *  @param frames the number of frames about to be charged
+ *  @return 1 if allowed, 0 if over the limit
+ */
+int pgd_acct_may_grow(void *pgd, int frames);
+
+/** @brief unmap a user page, dropping its frame reference (or its swap
+ *         slot), and free the frame on the last reference
+ *
+ *  @param pgd the pgd
+ *  @param linear_addr the linear address of the page
+ *  @return 0 on success, -1 if nothing is mapped there
+ */
+int pgd_unmap_page(void *pgd, void *linear_addr);
+
+/** @brief allocate frames for a range of linear address. On error the pages
+ *         allocated by this call are unmapped again.
  *
  *  @param pgd the pgd we want to insert page for
  *  @param start_linear_addr the starting linear address of inserting
@@ -113,6 +187,14 @@ void pgd_cleanup(void *pgd);
  */
 void *pt_entry_delete(void *pgd, void *linear_addr, int delete_pt);
 
+/** @brief get the address of the page table entry of a linear address
+ *
+ *  @param pgd the pgd we want to look into
+ *  @param linear_addr the linear address we want the entry of
+ *  @return the address of the entry if its page table exists, NULL if not
+ */
+void **pgd_get_pte(void *pgd, void *linear_addr);
+
 /** @brief get the frame of pgd at a linear address
  *
  *  @param pgd the pgd we want to get frame from
@@ -152,7 +234,9 @@ int pgd_check_valid(void *pgd);
 
 /** @brief clean up a pgd due to process exit. 
  *         This decrements all frame reference count by 1 (COW) and free frames if
- *         appropriate. Also frees the page tables
+ *         appropriate, FRAME_RELEASE_BATCH frames per lock acquisition. Also
+ *         frees the page tables and the pgd itself. The pgd must not be in
+ *         cr3 of anyone any more.
  *
  *  @param pgd the pgd we want to cleanup
  *  @return Void
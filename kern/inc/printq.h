@@ -0,0 +1,54 @@
+/** @file kern/inc/printq.h
+ *
+ *  @brief the queue between print and the console
+ *
+ *  print copies the buffer into a record, pushes it on a lock-free queue
+ *  and returns. The console worker, a kernel thread, pops the records and
+ *  draws each one whole under the print lock of its terminal, so the lines
+ *  of different processes never mix and a big print no longer holds up the
+ *  others, or the echo of what is typed. printq_flush waits until what was
+ *  queued before it is on the screen: print_flush, and the syscalls that
+ *  read or move the cursor or change the color, call it first so they see
+ *  the console the way the prints before them left it.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_PRINTQ_H_
+#define _KERN_INC_PRINTQ_H_
+
+#include <console.h>
+
+/* queue the prints for the console worker, 0 to draw them in the caller */
+#define PRINTQ_ENABLED 1
+
+/* the most bytes queued before a print waits for the worker to catch up,
+ * a print longer than this is drawn by its caller
+ */
+#define PRINTQ_MAX_BYTES (64 * 1024)
+
+/** @brief init the queue and start the console worker
+ *
+ *  @return 0 on success, -1 on error
+ */
+int printq_init(void);
+
+/** @brief queue a print for a terminal, or draw it right away if the queue
+ *         is not running, it is longer than PRINTQ_MAX_BYTES or out of
+ *         memory
+ *
+ *  @param vt the terminal
+ *  @param buf the bytes, copied before it returns
+ *  @param len the number of bytes
+ *  @return Void
+ */
+void printq_print(vterm_t *vt, const char *buf, int len);
+
+/** @brief wait until every print queued before the call is drawn
+ *
+ *  @return Void
+ */
+void printq_flush(void);
+
+#endif
@@ -0,0 +1,37 @@
+/** @file kern/inc/reaper.h
+ *
+ *  @brief background teardown of the address spaces of exited processes
+ *
+ *  The last thread of a process detaches its pgd and queues it here, so
+ *  the parent can be signalled right away. A kernel thread frees the
+ *  frames in batches later on. Whoever runs out of frames finishes the
+ *  queued teardowns itself.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_REAPER_H_
+#define _KERN_INC_REAPER_H_
+
+/** @brief init the teardown queue and start the reaper thread
+ *
+ *  @return 0 on success, -1 on error
+ */
+int reaper_init(void);
+
+/** @brief queue a detached pgd for teardown. Tears it down right away if
+ *         the reaper is not running.
+ *
+ *  @param pgd the pgd, not in cr3 of anyone any more
+ *  @return Void
+ */
+void reaper_enqueue(void *pgd);
+
+/** @brief tear down every queued pgd in the calling thread
+ *
+ *  @return the number of pgds torn down
+ */
+int reaper_drain(void);
+
+#endif
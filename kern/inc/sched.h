@@ -71,6 +71,17 @@ pcb_t *sched_find_pcb(int pid);
  */
 void sched_run();
 
+/**
+ * @brief start a kernel thread in the scheduler's process. fn runs on a
+ *        fresh kernel stack with interrupts disabled, it has to enable
+ *        them and must never return.
+ * 
+ * @param fn the body of the thread
+ * @return the new kernel thread, NULL on error.
+ *
+ */
+ktcb_t *sched_spawn_kthread(void (*fn)(void));
+
 /**
  * @brief add a process as a child process of the scheduler.
  * 
@@ -0,0 +1,69 @@
+/** @file kern/inc/serial_driver.h
+ *
+ *  @brief This file defines the serial (COM1) driver interface.
+ *
+ *  The driver runs the 16550 with its FIFOs on, and moves bytes between
+ *  them and two rings from the interrupt handler. What comes in is a second
+ *  keyboard for readline, what the console prints can go out as well.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_SERIAL_DRIVER_H_
+#define _KERN_INC_SERIAL_DRIVER_H_
+
+/* what the console does with the output of the foreground terminal: keep it
+ * off the serial port, copy it there, or send it there only (the screen is
+ * not touched). The same order as CONSOLE_SERIAL_OFF and on
+ */
+#define SERIAL_CONSOLE_OFF 0
+#define SERIAL_CONSOLE_MIRROR 1
+#define SERIAL_CONSOLE_REDIRECT 2
+
+/* the mode the console starts in */
+#define SERIAL_CONSOLE_DEFAULT SERIAL_CONSOLE_MIRROR
+
+/* the line speed */
+#define SERIAL_BAUD 115200
+
+/** @brief init the serial driver, if there is a COM1
+ *
+ *  @param idt_base_p the idt base
+ *  @return 0 on success, -1 if there is no serial port
+ */
+int serial_init(void *idt_base_p);
+
+/** @brief queue bytes to send, '\n' goes out as "\r\n". If the ring is
+ *         full, waits for the port to take the oldest bytes
+ *
+ *  @param buf the bytes
+ *  @param len the number of bytes
+ *  @return Void
+ */
+void serial_write(const char *buf, int len);
+
+/** @brief read the next byte received, '\r' comes back as '\n' and DEL as
+ *         '\b', like the keyboard types them
+ *
+ *  @return the byte if there's one, -1 if not
+ */
+int serial_readchar(void);
+
+/** @brief the console mode of the serial port
+ *
+ *  @return SERIAL_CONSOLE_OFF if there is no port, the mode otherwise
+ */
+int serial_console_mode(void);
+
+/** @brief set the console mode of the serial port (console_mode with a
+ *         CONSOLE_SERIAL_ mode)
+ *
+ *  @param mode SERIAL_CONSOLE_OFF, SERIAL_CONSOLE_MIRROR or
+ *         SERIAL_CONSOLE_REDIRECT
+ *  @return the mode before on success, -1 if mode is invalid or there is
+ *          no port to send to
+ */
+int serial_set_console_mode(int mode);
+
+#endif
@@ -0,0 +1,15 @@
+/** @file kern/serial_wrapper.h
+ *  @brief the interrupt handler wrapper for the serial port
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _SERIAL_WRAPPER_H_
+#define _SERIAL_WRAPPER_H_
+
+/** @brief the serial interrupt handler wrapper 
+ *
+ *  @return Void
+ */
+void serial_wrapper();
+
+#endif /* !_SERIAL_WRAPPER_H */
@@ -0,0 +1,59 @@
+/** @file kern/inc/spsc_ring.h
+ *  @brief header file for the single producer, single consumer byte ring
+ *
+ *  One side (an interrupt handler) only puts, the other only gets, so
+ *  neither takes a lock or disables interrupts: the producer only writes
+ *  tail, the consumer only writes head. The indices run free and are masked
+ *  into the buffer, whose length is a power of 2.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_SPSC_RING_H_
+#define _KERN_INC_SPSC_RING_H_
+
+/* spsc ring struct definition */
+typedef struct spsc_ring {
+    /* the buffer pointer, and its length - 1 */
+    unsigned char *buf;
+    unsigned int mask;
+
+    /* the next byte to get, and the next free one */
+    volatile unsigned int head;
+    volatile unsigned int tail;
+} spsc_ring_t;
+
+/** @brief init a spsc ring over a buffer
+ *
+ *  @param r the pointer to the ring struct
+ *  @param buf the buffer
+ *  @param len the length of the buffer, a power of 2
+ *  @return 0 on success, -1 on error
+ */
+int spsc_init(spsc_ring_t *r, unsigned char *buf, unsigned int len);
+
+/** @brief put a byte into the ring, producer only
+ *
+ *  @param r the pointer to the ring struct
+ *  @param c the byte
+ *  @return 0 on success, -1 if the ring is full
+ */
+int spsc_put(spsc_ring_t *r, unsigned char c);
+
+/** @brief get a byte from the ring, consumer only
+ *
+ *  @param r the pointer to the ring struct
+ *  @param c where to put the byte
+ *  @return 0 on success, -1 if the ring is empty
+ */
+int spsc_get(spsc_ring_t *r, unsigned char *c);
+
+/** @brief whether the ring is empty
+ *
+ *  @param r the pointer to the ring struct
+ *  @return 1 if empty, 0 if not
+ */
+int spsc_empty(spsc_ring_t *r);
+
+#endif
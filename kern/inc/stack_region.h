@@ -0,0 +1,121 @@
+/** @file kern/inc/stack_region.h
+ *
+ *  @brief grow-down user stack regions
+ *
+ *  A thread may register the stack it runs on with the stack_region
+ *  syscall. Faults below the mapped part of the stack, down to its limit,
+ *  are then resolved by the page fault handler itself, a few pages at a
+ *  time, instead of by a swexn handler calling new_pages. new_pages keeps
+ *  off the not yet mapped part of a region and the guard gap below it.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_STACK_REGION_H_
+#define _KERN_INC_STACK_REGION_H_
+
+#include <pcb.h>
+
+/* the number of pages a single fault maps below the stack */
+#define STACK_GROW_PAGES 4
+
+/* a grow-down stack region of a thread */
+typedef struct stack_region {
+    /* the thread running on it */
+    int tid;
+
+    /* the top of the stack, exclusive */
+    unsigned long hi;
+
+    /* the lowest mapped page */
+    unsigned long lo;
+
+    /* the stack never grows below this */
+    unsigned long limit;
+
+    /* the gap below limit new_pages keeps off */
+    unsigned long guard;
+
+    struct stack_region *next;
+} stack_region_t;
+
+/** @brief register (or replace) the stack region of a thread. Pages mapped
+ *         right below lo are taken into the region, nothing else may be
+ *         mapped between the limit minus the guard gap and lo.
+ *
+ *  @param pcb the process
+ *  @param tid the thread
+ *  @param hi the top of the stack, page aligned
+ *  @param lo the lowest mapped page of the stack
+ *  @param max_len the most the stack may span, 0 to unregister
+ *  @param guard_len the gap below the stack that stays unmapped
+ *  @return 0 on success, -1 on error
+ */
+int stack_region_set(pcb_t *pcb, int tid, unsigned long hi, unsigned long lo,
+                     int max_len, int guard_len);
+
+/** @brief unregister the stack region of a thread (if any)
+ *
+ *  @param pcb the process
+ *  @param tid the thread
+ *  @return Void
+ */
+void stack_region_remove(pcb_t *pcb, int tid);
+
+/** @brief copy the stack region of a thread into another process (fork)
+ *
+ *  @param from the forking process
+ *  @param from_tid the forking thread
+ *  @param to the new process
+ *  @param to_tid the root thread of the new process
+ *  @return 0 on success, -1 on error
+ */
+int stack_region_copy(pcb_t *from, int from_tid, pcb_t *to, int to_tid);
+
+/** @brief save the stack region of a thread (for process templates)
+ *
+ *  @param pcb the process
+ *  @param tid the thread
+ *  @param save where to save the region
+ *  @return 0 on success, -1 if the thread has no region
+ */
+int stack_region_save(pcb_t *pcb, int tid, stack_region_t *save);
+
+/** @brief give a thread a saved stack region
+ *
+ *  @param pcb the process
+ *  @param tid the thread
+ *  @param save the saved region
+ *  @return 0 on success, -1 on error
+ */
+int stack_region_restore(pcb_t *pcb, int tid, stack_region_t *save);
+
+/** @brief unregister all stack regions of a process
+ *
+ *  @param pcb the process
+ *  @return Void
+ */
+void stack_region_clear(pcb_t *pcb);
+
+/** @brief check if a range collides with a stack region or its guard gap
+ *
+ *  @param pcb the process
+ *  @param base the base of the range
+ *  @param len the length of the range
+ *  @return 1 if it does, 0 if not
+ */
+int stack_region_overlaps(pcb_t *pcb, unsigned long base, int len);
+
+/** @brief grow the stack region of a thread over a faulting address. The
+ *         pgd of the process has to be the one in cr3.
+ *
+ *  @param pcb the process
+ *  @param tid the faulting thread
+ *  @param fault_addr the faulting address
+ *  @return 0 if the fault got resolved, -1 if the address is not below
+ *          the stack of the thread or memory ran out
+ */
+int stack_region_grow(pcb_t *pcb, int tid, unsigned long fault_addr);
+
+#endif
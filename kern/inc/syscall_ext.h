@@ -0,0 +1,243 @@
+/** @file kern/inc/syscall_ext.h
+ *
+ *  @brief trap numbers and argument types of the syscalls this kernel
+ *         offers on top of the 410 spec. User space sees the same values
+ *         through user/inc/syscall_ext.h, keep the two in sync.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_SYSCALL_EXT_H_
+#define _KERN_INC_SYSCALL_EXT_H_
+
+#define SET_MEM_LIMIT_INT 0x80
+#define GET_MEM_USAGE_INT 0x81
+#define STACK_REGION_INT 0x82
+#define SPAWN_INT 0x83
+#define TEMPLATE_FREEZE_INT 0x84
+#define TEMPLATE_SPAWN_INT 0x85
+#define TEMPLATE_DROP_INT 0x86
+#define RING_SETUP_INT 0x87
+#define RING_ENTER_INT 0x88
+#define FUTEX_WAIT_INT 0x89
+#define FUTEX_WAKE_INT 0x8a
+#define SYSCALL_STATS_INT 0x8b
+#define CONSOLE_MODE_INT 0x8c
+#define SET_VTERM_INT 0x8d
+#define BLIT_CELLS_INT 0x8e
+#define CONSOLE_MAP_INT 0x8f
+#define POLL_INT 0x90
+#define PRINT_FLUSH_INT 0x91
+
+/* syscall numbers of the SYSENTER entry (in %eax). fork, thread_fork and
+ * template_freeze copy the trap frame of the int path, they have no number
+ */
+#define SYS_EXEC 0
+#define SYS_WAIT 1
+#define SYS_YIELD 2
+#define SYS_DESCHEDULE 3
+#define SYS_MAKE_RUNNABLE 4
+#define SYS_GETTID 5
+#define SYS_NEW_PAGES 6
+#define SYS_REMOVE_PAGES 7
+#define SYS_SLEEP 8
+#define SYS_GETCHAR 9
+#define SYS_READLINE 10
+#define SYS_PRINT 11
+#define SYS_SET_TERM_COLOR 12
+#define SYS_SET_CURSOR_POS 13
+#define SYS_GET_CURSOR_POS 14
+#define SYS_GET_TICKS 15
+#define SYS_MISBEHAVE 16
+#define SYS_HALT 17
+#define SYS_TASK_VANISH 18
+#define SYS_SET_STATUS 19
+#define SYS_VANISH 20
+#define SYS_READFILE 21
+#define SYS_SWEXN 22
+#define SYS_SET_MEM_LIMIT 23
+#define SYS_GET_MEM_USAGE 24
+#define SYS_STACK_REGION 25
+#define SYS_SPAWN 26
+#define SYS_TEMPLATE_SPAWN 27
+#define SYS_TEMPLATE_DROP 28
+#define SYS_RING_SETUP 29
+#define SYS_RING_ENTER 30
+#define SYS_FUTEX_WAIT 31
+#define SYS_FUTEX_WAKE 32
+#define SYS_SYSCALL_STATS 33
+#define SYS_CONSOLE_MODE 34
+#define SYS_SET_VTERM 35
+#define SYS_BLIT_CELLS 36
+#define SYS_CONSOLE_MAP 37
+#define SYS_POLL 38
+#define SYS_PRINT_FLUSH 39
+#define SYSENTER_NSYS 40
+
+/* what futex_wait returns besides 0 */
+#define FUTEX_EAGAIN (-2)
+#define FUTEX_ETIMEDOUT (-3)
+
+/* the console modes of console_mode */
+#define CONSOLE_MODE_SYNC 0
+#define CONSOLE_MODE_DEFERRED 1
+
+/* the serial modes of console_mode: keep the output of the foreground
+ * terminal off the serial port, copy it there, or send it there only
+ */
+#define CONSOLE_SERIAL_OFF 0x10
+#define CONSOLE_SERIAL_MIRROR 0x11
+#define CONSOLE_SERIAL_REDIRECT 0x12
+
+/* the virtual terminals of set_vterm, Alt+F1 to Alt+F4 show one */
+#define NVTERMS 4
+
+/* where console_map maps the cells of a terminal, CONSOLE_FB_ROWS rows of
+ * CONSOLE_FB_COLS cells, and a cell of character ch in color (the
+ * set_term_color colors), for console_map and blit_cells
+ */
+#define CONSOLE_FB_ADDR 0xff000000
+#define CONSOLE_FB_ROWS 25
+#define CONSOLE_FB_COLS 80
+#define CONSOLE_CELL_OF(ch, color) \
+    ((unsigned short)((((color) & 0xff) << 8) | ((ch) & 0xff)))
+
+/* the event sources of poll, and the most events one call takes */
+#define POLL_CONSOLE 0
+#define POLL_CHILD 1
+#define POLL_TIMER 2
+#define POLL_MAX_EVENTS 16
+
+/* the read only page the kernel keeps up to date in every address space,
+ * and the addresses of its fields (see vdso_data_t)
+ */
+#define VDSO_ADDR 0xff400000
+#define VDSO_TICKS (VDSO_ADDR + 0)
+#define VDSO_TSC_PER_TICK (VDSO_ADDR + 4)
+#define VDSO_USECS_PER_TICK (VDSO_ADDR + 8)
+#define VDSO_TID (VDSO_ADDR + 12)
+
+#ifndef ASSEMBLER
+
+/* the layout of the page at VDSO_ADDR */
+typedef struct vdso_data {
+    /* the timer ticks since boot, what get_ticks returns */
+    volatile unsigned int ticks;
+
+    /* time stamp counter cycles per tick, 0 until first calibrated */
+    volatile unsigned int tsc_per_tick;
+
+    /* the length of a tick in microseconds */
+    volatile unsigned int usecs_per_tick;
+
+    /* the tid of the running thread. There is a single cpu, so whoever
+     * reads it is the thread running
+     */
+    volatile int tid;
+} vdso_data_t;
+
+/* an event for poll */
+typedef struct poll_event {
+    /* POLL_CONSOLE, POLL_CHILD or POLL_TIMER */
+    int type;
+
+    /* the get_ticks() value a POLL_TIMER is ready at, unused otherwise */
+    unsigned int arg;
+
+    /* set by poll, 1 if the event is ready, 0 if not */
+    int revents;
+} poll_event_t;
+
+/* the memory usage of the calling process, in pages */
+typedef struct mem_usage {
+    /* present user pages */
+    int resident;
+
+    /* present user pages still shared copy-on-write */
+    int shared;
+
+    /* user pages compressed into the swap pool */
+    int swapped;
+
+    /* page tables of the user region */
+    int pt_pages;
+
+    /* most private (resident - shared) frames allowed, 0 for no limit */
+    int max_frames;
+
+    /* COW write faults fault-around saved, this process and everyone */
+    int faults_saved;
+    int faults_saved_all;
+} mem_usage_t;
+
+/* a submission: what the stub of syscall op would put in esi */
+typedef struct ring_sqe {
+    /* the SYS_* number of the syscall */
+    int op;
+
+    /* the argument, the packet address or the single value */
+    int arg;
+
+    /* handed back untouched in the completion */
+    unsigned int user_data;
+    int pad;
+} ring_sqe_t;
+
+/* a completion */
+typedef struct ring_cqe {
+    /* the user_data of the submission */
+    unsigned int user_data;
+
+    /* what the syscall returned */
+    int res;
+} ring_cqe_t;
+
+/* the head of a ring, the two queues follow it. The indexes only grow,
+ * slot i of a queue is i & (entries - 1). User space moves sq_tail and
+ * cq_head, the kernel sq_head and cq_tail.
+ */
+typedef struct ring {
+    volatile unsigned int sq_head;
+    volatile unsigned int sq_tail;
+    volatile unsigned int cq_head;
+    volatile unsigned int cq_tail;
+} ring_t;
+
+/* the queues of a ring, and its size */
+#define RING_SQES(r) ((ring_sqe_t *)((ring_t *)(r) + 1))
+#define RING_CQES(r, entries) ((ring_cqe_t *)(RING_SQES(r) + (entries)))
+#define RING_SIZE(entries) (sizeof(ring_t) + \
+                            (entries) * (sizeof(ring_sqe_t) + \
+                                         sizeof(ring_cqe_t)))
+
+/* the most slots in a queue */
+#define RING_MAX_ENTRIES 1024
+
+/* the log2 latency buckets of a syscall, the last one takes the rest */
+#define SYSCALL_STAT_BUCKETS 32
+
+/* the statistics of one syscall (see syscall_stats), indexed by SYS_
+ * number. A call is counted when it returns, so vanish and a successful
+ * exec never are; fork, thread_fork and template_freeze have no number.
+ */
+typedef struct syscall_stat {
+    /* calls made */
+    unsigned int calls;
+
+    /* calls that returned a negative number */
+    unsigned int errors;
+
+    /* TSC cycles from entering the handler to leaving it, blocking
+     * included
+     */
+    unsigned long long total_cycles;
+    unsigned long long max_cycles;
+
+    /* hist[i] counts the calls that took [2^i, 2^(i+1)) cycles */
+    unsigned int hist[SYSCALL_STAT_BUCKETS];
+} syscall_stat_t;
+
+#endif /* !ASSEMBLER */
+
+#endif
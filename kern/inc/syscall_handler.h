@@ -12,9 +12,8 @@
 #include <ureg.h>
 #include <syscall.h>
 #include <mutex.h>
-
-/* lock the console print screen */
-extern mutex_t print_mp;
+#include <pcb.h>
+#include <console.h>
 
 /**
  * @brief check cs, ss and eflags of a register
@@ -26,28 +25,35 @@ extern mutex_t print_mp;
 int check_newureg(ureg_t *ureg);
 
 /**
- * @brief initialize the syscall handlers.
+ * @brief check the execname and argvec of exec (or spawn): they have to be
+ *        accessible, and argvec[0] has to be execname.
  *
- * @return 0 if successful, -1 otherwise.
+ * @param pcb the calling process.
+ * @param pgd the pgd of the calling process.
+ * @param execname the program name.
+ * @param argvec the NULL terminated argument vector.
+ * @return 1 if successful, 0 otherwise.
  *
  */
-int syscall_init(); 
+int check_exec_args(pcb_t *pcb, void *pgd, char *execname, char **argvec);
 
 /**
- * @brief initialize the mutex lock for print
+ * @brief initialize the syscall handlers.
  *
  * @return 0 if successful, -1 otherwise.
  *
  */
-int print_init();
+int syscall_init(); 
 
 /**
- * @brief fill the console with keyboard without context switch.
+ * @brief fill the input line of a terminal with keyboard without context
+ *        switch.
  *
+ * @param vt the terminal.
  * @return Void.
  *
  */
-void fill_cons();
+void fill_cons(vterm_t *vt);
 
 
 #endif
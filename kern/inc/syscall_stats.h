@@ -0,0 +1,47 @@
+/** @file kern/inc/syscall_stats.h
+ *
+ *  @brief per syscall statistics
+ *
+ *  With SYSCALL_STATS_ENABLED on, the syscall wrappers (common_wrapper.S)
+ *  call the handlers through syscall_stats_call, which times them with
+ *  the TSC and adds the call to the table of the process and to the
+ *  global one. With it off the wrappers call the handlers directly, the
+ *  tables are not compiled in and syscall_stats fails.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_SYSCALL_STATS_H_
+#define _KERN_INC_SYSCALL_STATS_H_
+
+/* 1 to count and time the syscalls, 0 to leave the wrappers alone */
+#define SYSCALL_STATS_ENABLED 1
+
+#ifndef ASSEMBLER
+
+#include <syscall_ext.h>
+
+/* one entry per SYS_ number */
+#define SYSCALL_STAT_NSYS SYSENTER_NSYS
+
+/** @brief call a syscall handler and account for it
+ *
+ *  @param handler the handler
+ *  @param nr the SYS_ number of the syscall
+ *  @param arg what the user put in esi
+ *  @return what the handler returned
+ */
+int syscall_stats_call(int (*handler)(void *), int nr, void *arg);
+
+/** @brief copy the statistics of a process, or the global ones
+ *
+ *  @param pid the process, 0 for the global table
+ *  @param stats where to copy SYSCALL_STAT_NSYS entries
+ *  @return 0 on success, -1 if there is no such process
+ */
+int syscall_stats_copy(int pid, syscall_stat_t *stats);
+
+#endif /* !ASSEMBLER */
+
+#endif
@@ -0,0 +1,39 @@
+/** @file kern/inc/sysenter.h
+ *
+ *  @brief the SYSENTER/SYSEXIT syscall entry
+ *
+ *  Besides the int trap gates, user space may enter the kernel with
+ *  SYSENTER, passing the SYS_ number of syscall_ext.h in eax. SYSENTER
+ *  loads esp from an MSR instead of the TSS, so the MSR follows esp0 of
+ *  the running kernel thread.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_SYSENTER_H_
+#define _KERN_INC_SYSENTER_H_
+
+/* the SYSENTER model specific registers */
+#define MSR_SYSENTER_CS 0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
+
+/* the handlers by SYS_ number (common_wrapper.S) */
+extern int (*sysenter_table[])(void *);
+
+/** @brief point the SYSENTER MSRs at sysenter_wrapper
+ *
+ *  @return 0 on success, -1 if the segments do not have the layout
+ *          SYSEXIT expects (SYSENTER then stays off)
+ */
+int sysenter_init(void);
+
+/** @brief set the kernel stack SYSENTER switches to, along with esp0
+ *
+ *  @param esp0 the top of the kernel stack of the running kernel thread
+ *  @return Void
+ */
+void sysenter_set_esp0(unsigned long esp0);
+
+#endif
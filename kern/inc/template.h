@@ -0,0 +1,103 @@
+/** @file kern/inc/template.h
+ *
+ *  @brief process templates
+ *
+ *  template_freeze snapshots the calling (single threaded) process: its
+ *  address space is copied copy-on-write into a pgd of its own, like fork
+ *  does, and the trap frame of the call is saved. template_spawn then
+ *  starts new processes from the snapshot with another copy-on-write copy,
+ *  so they begin where the freezer returned from template_freeze, past
+ *  whatever initialization it did before.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_TEMPLATE_H_
+#define _KERN_INC_TEMPLATE_H_
+
+#include <reg.h>
+#include <stack_region.h>
+
+/* the most templates alive at once */
+#define TEMPLATE_MAX 16
+
+/* a frozen process */
+typedef struct template {
+    /* the id handed out by template_freeze */
+    int id;
+
+    /* the pid of the process that froze it, the only one that may drop it */
+    int owner;
+
+    /* one for the table, plus one per template_spawn using it */
+    int refs;
+
+    /* the copy-on-write copy of the address space */
+    void *pgd;
+
+    /* the registers of the root thread */
+    reg_t *regs;
+
+    /* the kernel stack from the trap frame down to the freeze handler */
+    char *kstack;
+    int kstack_len;
+
+    /* the stack region of the root thread, if it had one */
+    int has_stack;
+    stack_region_t stack;
+
+    /* the read only memory regions */
+    void *txt_base;
+    int txt_len;
+    void *rodat_base;
+    int rodat_len;
+} template_t;
+
+/** @brief init the template table
+ *
+ *  @return 0 on success, -1 on error
+ */
+int template_init(void);
+
+/** @brief put a template into the table, it gets its id and the table's
+ *         reference
+ *
+ *  @param t the template
+ *  @return the id on success, -1 if the table is full
+ */
+int template_add(template_t *t);
+
+/** @brief take a reference on a template
+ *
+ *  @param id the id of the template
+ *  @return the template, NULL if there is no such template
+ */
+template_t *template_get(int id);
+
+/** @brief drop a reference on a template, and free it on the last one
+ *
+ *  @param t the template
+ *  @return Void
+ */
+void template_put(template_t *t);
+
+/** @brief take a template out of the table, it is freed once the spawns
+ *         still using it are done
+ *
+ *  @param id the id of the template
+ *  @param pid the process asking, it has to be the one that froze it
+ *  @return 0 on success, -1 if there is no such template or it is not pid's
+ */
+int template_remove(int id, int pid);
+
+/** @brief take every template a process froze out of the table, when the
+ *         process goes away. Each is freed once the spawns still using it
+ *         are done
+ *
+ *  @param pid the process
+ *  @return Void
+ */
+void template_remove_owned(int pid);
+
+#endif
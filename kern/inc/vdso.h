@@ -0,0 +1,55 @@
+/** @file kern/inc/vdso.h
+ *
+ *  @brief the page shared read only with every address space
+ *
+ *  A single kernel page, laid out as vdso_data_t, is mapped at VDSO_ADDR
+ *  through a page table of its own. Its pgd entry is set in kern_pgd, so
+ *  exec and spawn get it with the kernel entries, and fork copies it like
+ *  them. The user page walks skip it. The timer keeps the tick count and
+ *  the time stamp counter calibration on it current, the context switch
+ *  the tid, so user space reads them without trapping.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_VDSO_H_
+#define _KERN_INC_VDSO_H_
+
+#include <syscall_ext.h>
+
+/* the pgd entry of the page */
+#define VDSO_PGD_INDEX (VDSO_ADDR >> 22)
+
+/* the ticks between two calibrations of tsc_per_tick, as a shift */
+#define VDSO_CALIBRATE_SHIFT 5
+
+/** @brief map the page into kern_pgd, before any program is loaded
+ *
+ *  @return 0 on success, -1 on error
+ */
+int vdso_init(void);
+
+/** @brief set the length of a tick
+ *
+ *  @param usecs the microseconds per tick
+ *  @return Void
+ */
+void vdso_set_tick_usecs(unsigned int usecs);
+
+/** @brief publish a timer tick, and recalibrate the time stamp counter
+ *         every so often. Called from the timer interrupt.
+ *
+ *  @param ticks the ticks since boot
+ *  @return Void
+ */
+void vdso_tick(unsigned int ticks);
+
+/** @brief publish the tid of the thread about to run
+ *
+ *  @param tid the tid
+ *  @return Void
+ */
+void vdso_set_tid(int tid);
+
+#endif
@@ -0,0 +1,107 @@
+/** @file kern/inc/waitq.h
+ *
+ *  @brief wait queues a thread can block on several of at once
+ *
+ *  An event source (a terminal's input line, the children of a process)
+ *  keeps a waitq_t. A thread that waits for any of a set of sources links
+ *  one entry per source, all pointing at the waitq_thread_t it blocks
+ *  with, checks the sources, and sleeps unless one of them woke it in the
+ *  meantime. Waking a queue unlinks its entries front to back and makes
+ *  each thread runnable once: O(1) per waiter, no scanning for who waits
+ *  on what. Everything is done with interrupts disabled, like the
+ *  scheduler queues, so sources can wake from interrupt handlers.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_WAITQ_H_
+#define _KERN_INC_WAITQ_H_
+
+/* declare ktcb type */
+struct ktcb;
+
+/* a thread waiting on wait queues, it lives on its kernel stack */
+typedef struct waitq_thread {
+    struct ktcb *ktcb;
+
+    /* set by the first wake, and if it is blocked (and in the sleep queue
+     * too, for a timeout)
+     */
+    int woken;
+    int asleep;
+    int timed;
+} waitq_thread_t;
+
+/* the link of a thread into one wait queue */
+typedef struct waitq_entry {
+    waitq_thread_t *thr;
+
+    /* the queue it is in, NULL once a wake took it out */
+    struct waitq *q;
+
+    struct waitq_entry *prev;
+    struct waitq_entry *next;
+} waitq_entry_t;
+
+/* wait queue struct definition, the oldest entry first */
+typedef struct waitq {
+    waitq_entry_t *head;
+    waitq_entry_t *tail;
+} waitq_t;
+
+/** @brief init a wait queue
+ *
+ *  @param q the wait queue
+ *  @return Void
+ */
+void waitq_init(waitq_t *q);
+
+/** @brief whether nobody waits on a wait queue
+ *
+ *  @param q the wait queue
+ *  @return 1 if empty, 0 if not
+ */
+int waitq_empty(waitq_t *q);
+
+/** @brief get the running thread ready to wait
+ *
+ *  @param thr the thread record
+ *  @return Void
+ */
+void waitq_thread_init(waitq_thread_t *thr);
+
+/** @brief link a thread into a wait queue
+ *
+ *  @param q the wait queue
+ *  @param e the entry, it stays linked until waitq_remove or a wake
+ *  @param thr the thread record
+ *  @return Void
+ */
+void waitq_add(waitq_t *q, waitq_entry_t *e, waitq_thread_t *thr);
+
+/** @brief unlink an entry, if a wake did not already
+ *
+ *  @param e the entry
+ *  @return Void
+ */
+void waitq_remove(waitq_entry_t *e);
+
+/** @brief wake every thread waiting on a wait queue
+ *
+ *  @param q the wait queue
+ *  @return Void
+ */
+void waitq_wake(waitq_t *q);
+
+/** @brief block the running thread until one of its wait queues wakes it,
+ *         unless one already did
+ *
+ *  @param thr the thread record
+ *  @param timed whether to give up at deadline
+ *  @param deadline the tick to give up at
+ *  @return 1 if a wait queue woke it, 0 if it timed out
+ */
+int waitq_sleep(waitq_thread_t *thr, int timed, unsigned int deadline);
+
+#endif
@@ -0,0 +1,128 @@
+/** @file kern/inc/zswap.h
+ *
+ *  @brief compressed swap to a RAM pool
+ *
+ *  When free_frame_queue runs dry, a clock over the user frames picks pages
+ *  whose accessed bit stayed clear for a whole sweep, compresses them into
+ *  a pool on the kernel heap and frees their frames. The page table entry
+ *  becomes a non-present swap entry (see SWAP_ENTRY in pgtable.h), and the
+ *  page fault handler decompresses the page back on the next touch.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _KERN_INC_ZSWAP_H_
+#define _KERN_INC_ZSWAP_H_
+
+/* the number of slots in the pool, slot 0 is never used */
+#define ZSWAP_MAX_SLOTS 4096
+
+/* the most kernel heap the pool may hold */
+#define ZSWAP_POOL_LIMIT (2 * 1024 * 1024)
+
+/* pages compressing worse than this are left resident */
+#define ZSWAP_MAX_STORE (PAGE_SIZE * 3 / 4)
+
+/* the number of frames to reclaim when an allocation fails */
+#define ZSWAP_RECLAIM_BATCH 16
+
+/* kernel only window for reading and writing frames of other processes.
+ * It sits in its own page table so vm_frm_copy's LAST_PAGE_ADDR page
+ * table can come and go underneath it.
+ */
+#define ZSWAP_SCRATCH_ADDR ((void *)0xffbff000)
+
+/* the statistics of the swap pool */
+typedef struct zswap_stats {
+    /* pages and compressed bytes currently in the pool */
+    unsigned long stored_pages;
+    unsigned long stored_bytes;
+
+    /* pages ever compressed out and faulted back in */
+    unsigned long pages_out;
+    unsigned long pages_in;
+
+    /* pages that did not compress below ZSWAP_MAX_STORE */
+    unsigned long rejected;
+
+    /* cycles spent in zswap_fault_in */
+    unsigned long long in_cycles;
+    unsigned long long in_cycles_max;
+} zswap_stats_t;
+
+/** @brief init the swap pool
+ *
+ *  @return 0 on success, -1 on error
+ */
+int zswap_init(void);
+
+/** @brief run the clock and compress cold pages until target frames are
+ *         freed or two sweeps over all frames went by
+ *
+ *  @param target the number of frames we want back
+ *  @return the number of frames freed
+ */
+int zswap_reclaim(int target);
+
+/** @brief check if a linear address of a pgd is swapped out
+ *
+ *  @param pgd the pgd
+ *  @param linear_addr the linear address
+ *  @return 1 if swapped out, 0 if not
+ */
+int zswap_is_swapped(void *pgd, void *linear_addr);
+
+/** @brief bring a swapped out page back into a fresh frame. The pgd has to
+ *         be the one in cr3.
+ *
+ *  @param pgd the pgd
+ *  @param linear_addr the faulting linear address
+ *  @return 0 on success, -1 on error
+ */
+int zswap_fault_in(void *pgd, void *linear_addr);
+
+/** @brief drop a swap entry of a pgd (for remove_pages)
+ *
+ *  @param pgd the pgd
+ *  @param linear_addr the linear address of the entry
+ *  @return 1 if the entry was a swap entry and got dropped, 0 if not
+ */
+int zswap_drop(void *pgd, void *linear_addr);
+
+/** @brief take another reference on a slot (a swap entry got copied)
+ *
+ *  @param slot the slot
+ *  @return Void
+ */
+void zswap_dup(int slot);
+
+/** @brief release a reference on a slot, and free it on the last one
+ *
+ *  @param slot the slot
+ *  @return Void
+ */
+void zswap_put(int slot);
+
+/** @brief wait until a clock sweep in progress is over. A pgd marked
+ *         dying is never picked by the sweeps that start afterwards.
+ *
+ *  @return Void
+ */
+void zswap_barrier(void);
+
+/** @brief get a snapshot of the pool statistics
+ *
+ *  @param stats where to store the statistics
+ *  @return Void
+ */
+void zswap_get_stats(zswap_stats_t *stats);
+
+/** @brief print the compression ratio and fault-in latency to the simics
+ *         console
+ *
+ *  @return Void
+ */
+void zswap_report(void);
+
+#endif
@@ -27,6 +27,8 @@
 #include <vm.h>
 
 #include <loader.h>
+#include <exec_index.h>
+#include <template.h>
 
 #include <driver.h>
 #include <pcb.h>
@@ -43,6 +45,9 @@
 #include <pgtable.h>
 #include <x86/cr.h>
 #include <malloc_init.h>
+#include <reaper.h>
+#include <printq.h>
+#include <vdso.h>
 
 static char *tag = "kernel";
 
@@ -91,6 +96,10 @@ int kernel_main(mbinfo_t *mbinfo, int argc, char **argv, char **envp)
     report_progress(tag, "going to init vm..");
     vm_init();
 
+    /* the shared page goes into kern_pgd before the first program */
+    report_progress(tag, "going to init vdso");
+    vdso_init();
+
     // initialize pcb block for running first process
     report_progress(tag, "going to init pcb pool and kthread pool...");
     pcb_pool_init();
@@ -103,6 +112,10 @@ int kernel_main(mbinfo_t *mbinfo, int argc, char **argv, char **envp)
     report_progress(tag, "going to init console");
     cons_init();
 
+    /* index the programs before loading any */
+    report_progress(tag, "going to init exec index");
+    exec_index_init();
+
     /* load the first program */
     report_progress(tag, "going to load prog...");
     ktcb_t *ktcb1 = kthr_alloc();
@@ -115,6 +128,18 @@ int kernel_main(mbinfo_t *mbinfo, int argc, char **argv, char **envp)
    
     /* initialize the malloc mutex */
     malloc_init();
+
+    /* start the thread that tears down exited address spaces */
+    report_progress(tag, "going to init reaper");
+    reaper_init();
+
+    /* start the thread that draws what print queues */
+    report_progress(tag, "going to init print queue");
+    printq_init();
+
+    /* the process template table */
+    report_progress(tag, "going to init templates");
+    template_init();
     
     report_progress(tag, "going into sched_run");
         
@@ -81,6 +81,7 @@ ktcb_t *kthr_alloc(void)
     }
     
     ktcb->blocked_mutex = NULL;
+    ktcb->futex_w = NULL;
     return ktcb;
 }
 
@@ -0,0 +1,164 @@
+/** @file kern/ldisc.c
+ *
+ *  @brief line discipline implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <ldisc.h>
+#include <common_include.h>
+#include <malloc.h>
+
+static char *tag = "ldisc";
+
+#define LDISC_MASK (LDISC_BUF_LEN - 1)
+
+/** @brief make the oldest reader runnable, if it is not already.
+ *         Interrupts disabled
+ *
+ *  @param ld the pointer to the ldisc struct
+ *  @return Void
+ */
+static void ldisc_wake(ldisc_t *ld)
+{
+    ldisc_waiter_t *w = ld->waiters;
+
+    if (w == NULL || w->woken)
+        return;
+
+    w->woken = 1;
+    sched_running_to_runnable(w->ktcb);
+}
+
+int ldisc_init(ldisc_t *ld)
+{
+    if ((ld->buf = malloc(LDISC_BUF_LEN)) == NULL) {
+        report_error(tag, "ldisc_init: can't allocate the ring");
+        return -1;
+    }
+
+    ld->head = 0;
+    ld->edit = 0;
+    ld->tail = 0;
+    ld->waiters = NULL;
+    ld->waiters_tail = &(ld->waiters);
+    waitq_init(&(ld->pollers));
+
+    return 0;
+}
+
+int ldisc_input(ldisc_t *ld, char c)
+{
+    int if_was_set = if_disable();
+
+    if (c == '\b') {
+        /* the completed lines are not ours to erase */
+        if (ld->tail == ld->edit) {
+            if_recover(if_was_set);
+            return -1;
+        }
+        ld->tail--;
+    }
+    else {
+        /* the last slot is kept for the '\n' that completes the line */
+        if (LDISC_BUF_LEN - (ld->tail - ld->head) < (c == '\n' ? 1 : 2)) {
+            if_recover(if_was_set);
+            report_warning(tag, "ldisc_input: ring is full");
+            return -1;
+        }
+
+        ld->buf[ld->tail & LDISC_MASK] = c;
+        ld->tail++;
+
+        if (c == '\n') {
+            ld->edit = ld->tail;
+            ldisc_wake(ld);
+            waitq_wake(&(ld->pollers));
+        }
+    }
+
+    if_recover(if_was_set);
+    return 0;
+}
+
+int ldisc_waiting(ldisc_t *ld)
+{
+    return ld->waiters != NULL || !waitq_empty(&(ld->pollers));
+}
+
+int ldisc_readable(ldisc_t *ld)
+{
+    return ld->head != ld->edit;
+}
+
+int ldisc_read(ldisc_t *ld, char *buf, int len)
+{
+    ldisc_waiter_t w;
+    unsigned int head, avail, off, first, n;
+    char *nl;
+    int if_was_set;
+
+    w.ktcb = running_ktcb;
+    w.woken = 0;
+    w.next = NULL;
+
+    if_was_set = if_disable();
+
+    *(ld->waiters_tail) = &w;
+    ld->waiters_tail = &(w.next);
+
+    /* wait for our turn, and for a completed line */
+    while (ld->waiters != &w || ld->head == ld->edit) {
+        report_progress(tag, "ldisc_read: %p blocks", running_ktcb);
+        cs_save_and_switch(running_ktcb, sched_next());
+        w.woken = 0;
+    }
+
+    head = ld->head;
+    avail = ld->edit - head;
+
+    if_recover(if_was_set);
+
+    /* the rest of the first line, in at most two pieces. Only the oldest
+     * reader moves head, and the producer stays past edit
+     */
+    if ((unsigned int)len > avail)
+        len = avail;
+
+    off = head & LDISC_MASK;
+    first = LDISC_BUF_LEN - off;
+    if (first > (unsigned int)len)
+        first = len;
+
+    if ((nl = memchr(ld->buf + off, '\n', first)) != NULL) {
+        n = nl - (ld->buf + off) + 1;
+        memcpy(buf, ld->buf + off, n);
+    }
+    else {
+        memcpy(buf, ld->buf + off, first);
+        n = first;
+
+        if (first < (unsigned int)len) {
+            nl = memchr(ld->buf, '\n', len - first);
+            n = (nl != NULL) ? (unsigned int)(nl - ld->buf + 1) + first :
+                               (unsigned int)len;
+            memcpy(buf + first, ld->buf, n - first);
+        }
+    }
+
+    if_was_set = if_disable();
+
+    ld->head = head + n;
+
+    /* leave the queue, and pass on what is left */
+    ld->waiters = w.next;
+    if (ld->waiters == NULL)
+        ld->waiters_tail = &(ld->waiters);
+    else if (ld->head != ld->edit)
+        ldisc_wake(ld);
+
+    if_recover(if_was_set);
+
+    return n;
+}
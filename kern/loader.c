@@ -20,6 +20,7 @@
 #include <exec2obj.h>
 #include <loader.h>
 #include <elf_410.h>
+#include <exec_index.h>
 #include <vm.h>
 #include <pgtable.h>
 #include <cr.h>
@@ -47,27 +48,13 @@ static char *tag = "loader";
  */
 int getbytes( const char *filename, int offset, int size, char *buf )
 {
-    int i;
-    for (i = 0; i < exec2obj_userapp_count; i++) {
-        if (strcmp(filename, exec2obj_userapp_TOC[i].execname) == 0)
-            break;
-    }
+    const exec_entry_t *e = exec_index_lookup(filename);
 
-    if (i == exec2obj_userapp_count)
+    if (e == NULL)
         /* can't find filename in table of contents */
         return -1;
 
-    int execlen = exec2obj_userapp_TOC[i].execlen;
-    int length = execlen - offset;
-
-    char *ret = memcpy(buf, exec2obj_userapp_TOC[i].execbytes + offset,
-                       length > size ? size : length);
-
-    if (ret != buf)
-        /* memcpy failed */
-        return -1;
-
-    return length > size ? size : length;
+    return exec_index_read(e, offset, size, buf);
 }
 
 ktcb_t *register_ktcb(tcb_t *tcb) {
@@ -211,12 +198,18 @@ pcb_t *load_prog(char *filename, char **argvec, pcb_t *pcb, tid_t tid,
 
     void *orig_pgd = (pcb == NULL) ? kern_pgd : (void *)(pcb->pgd);
 
-    simple_elf_t elf_header;
-    /* fill in elf_header */
-    if (elf_load_helper(&elf_header, filename) != ELF_SUCCESS) {
+    /* the frame limit survives exec */
+    PGD_ACCT(pgd)->max_frames = PGD_ACCT(orig_pgd)->max_frames;
+
+    /* the elf header was parsed at boot */
+    const exec_entry_t *entry = exec_index_lookup(filename);
+    if (entry == NULL || !entry->is_elf) {
         report_warning(tag, "file is not in elf format.");
+
+        pgd_free(pgd);
         return NULL;
     }
+    simple_elf_t elf_header = entry->elf;
     
     /* save user argvec to kernel */
     report_progress(tag, "load_prog: saving argvec to kernel");
@@ -306,7 +299,7 @@ pcb_t *load_prog(char *filename, char **argvec, pcb_t *pcb, tid_t tid,
             return NULL;
         }
 
-        getbytes(saved_argvec[0], elf_header.e_datoff, elf_header.e_datlen, 
+        exec_index_read(entry, elf_header.e_datoff, elf_header.e_datlen, 
                     (void *)elf_header.e_datstart);
     }
 
@@ -329,7 +322,7 @@ pcb_t *load_prog(char *filename, char **argvec, pcb_t *pcb, tid_t tid,
             return NULL;
         }
 
-        getbytes(saved_argvec[0], elf_header.e_txtoff, elf_header.e_txtlen, 
+        exec_index_read(entry, elf_header.e_txtoff, elf_header.e_txtlen, 
                     (void *)elf_header.e_txtstart);
     }
    
@@ -352,7 +345,7 @@ pcb_t *load_prog(char *filename, char **argvec, pcb_t *pcb, tid_t tid,
             return NULL;
         }
 
-        getbytes(saved_argvec[0], elf_header.e_rodatoff, elf_header.e_rodatlen, 
+        exec_index_read(entry, elf_header.e_rodatoff, elf_header.e_rodatlen, 
                     (void *)elf_header.e_rodatstart);
     }
 
@@ -0,0 +1,248 @@
+/** @file kern/lock/futex.c
+ *
+ *  @brief futex wait queues implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <futex.h>
+#include <common_include.h>
+#include <timed_queue.h>
+#include <zswap.h>
+#include <syscall_ext.h>
+
+static char *tag = "futex";
+
+/* the wait queues, oldest waiter first */
+static futex_waiter_t *futex_buckets[FUTEX_BUCKETS];
+
+/* the wait queue of a key */
+#define FUTEX_BUCKET(key) \
+    (((unsigned long)(key) >> 2 ^ (unsigned long)(key) >> 12) & \
+     (FUTEX_BUCKETS - 1))
+
+/** @brief compute the key of a user word. On success it returns with
+ *         interrupts disabled, so the page stays where the key says.
+ *
+ *  @param addr the user address of the word
+ *  @param key where to put the key
+ *  @param if_was_set where to put the interrupt flag to recover
+ *  @return 0 on success, -1 if the word is not accessible
+ */
+static int futex_key(int *addr, unsigned long *key, int *if_was_set)
+{
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    void *pgd = (void *)pcb->pgd;
+    void **pte;
+
+    if (((unsigned long)addr & 3) ||
+        (unsigned long)addr < USER_MEM_START ||
+        (unsigned long)addr >= USER_STACK_BASE) {
+        report_error(tag, "futex_key: bad address %p", addr);
+        return -1;
+    }
+
+    if (vm_mem_check(pcb, pgd, addr) != 1) {
+        report_error(tag, "futex_key: %p not writable", addr);
+        return -1;
+    }
+
+    while (1) {
+        *if_was_set = if_disable();
+
+        pte = pgd_get_pte(pgd, addr);
+        if (pte != NULL && PG_IS_PRESENT(*pte)) {
+            *key = (unsigned long)GET_ADDRESS(*pte) |
+                   ((unsigned long)addr & (PAGE_SIZE - 1));
+            return 0;
+        }
+
+        if_recover(*if_was_set);
+
+        /* bring it back and look again, the clock may take it right away */
+        if (pte == NULL || !IS_SWAPPED(*pte) ||
+            zswap_fault_in(pgd, addr) != 0) {
+            report_error(tag, "futex_key: %p not mapped", addr);
+            return -1;
+        }
+    }
+}
+
+/** @brief take a waiter out of its wait queue, interrupts disabled
+ *
+ *  @param w the waiter
+ *  @return Void
+ */
+static void futex_unlink(futex_waiter_t *w)
+{
+    futex_waiter_t **p = &(futex_buckets[FUTEX_BUCKET(w->key)]);
+
+    while (*p != NULL) {
+        if (*p == w) {
+            *p = w->next;
+            break;
+        }
+        p = &((*p)->next);
+    }
+
+    w->next = NULL;
+    w->ktcb->futex_w = NULL;
+}
+
+int futex_wait(int *addr, int expected, int timeout)
+{
+    futex_waiter_t w, **p;
+    int if_was_set;
+
+    if (timeout < 0) {
+        report_error(tag, "futex_wait: negative timeout");
+        return -1;
+    }
+
+    if (futex_key(addr, &(w.key), &if_was_set) != 0)
+        return -1;
+
+    /* a wake in between already changed the word, don't block */
+    if (*addr != expected) {
+        if_recover(if_was_set);
+        return FUTEX_EAGAIN;
+    }
+
+    w.ktcb = running_ktcb;
+    w.pgd = (void *)running_ktcb->tcb->pcb->pgd;
+    w.woken = 0;
+    w.timed = (timeout > 0);
+    w.next = NULL;
+
+    for (p = &(futex_buckets[FUTEX_BUCKET(w.key)]); *p != NULL;
+         p = &((*p)->next))
+        continue;
+    *p = &w;
+    running_ktcb->futex_w = &w;
+
+    if (w.timed)
+        sched_running_to_sleep(running_ktcb, ticks_global + timeout);
+
+    report_progress(tag, "futex_wait: %p blocks on key %p", running_ktcb,
+                    (void *)w.key);
+    cs_save_and_switch(running_ktcb, sched_next());
+
+    /* the sleep queue let go of us first */
+    if (!w.woken) {
+        futex_unlink(&w);
+        if_recover(if_was_set);
+
+        report_progress(tag, "futex_wait: %p timed out", running_ktcb);
+        return FUTEX_ETIMEDOUT;
+    }
+
+    if_recover(if_was_set);
+    return 0;
+}
+
+int futex_wake(int *addr, int n)
+{
+    futex_waiter_t *w, **p;
+    unsigned long key;
+    int if_was_set;
+    int woken = 0;
+
+    if (n <= 0)
+        return 0;
+
+    if (futex_key(addr, &key, &if_was_set) != 0)
+        return -1;
+
+    p = &(futex_buckets[FUTEX_BUCKET(key)]);
+    while (*p != NULL && woken < n) {
+        w = *p;
+        if (w->key != key) {
+            p = &(w->next);
+            continue;
+        }
+
+        *p = w->next;
+        w->next = NULL;
+        w->woken = 1;
+        w->ktcb->futex_w = NULL;
+
+        /* a timed waiter the sleep queue already let go of is runnable */
+        if (!w->timed || tq_delete(w->ktcb) != 0)
+            sched_running_to_runnable(w->ktcb);
+
+        woken++;
+    }
+
+    if_recover(if_was_set);
+
+    report_progress(tag, "futex_wake: woke %d on key %p", woken,
+                    (void *)key);
+    return woken;
+}
+
+int futex_cancel(ktcb_t *ktcb)
+{
+    int if_was_set = if_disable();
+
+    if (ktcb->futex_w == NULL) {
+        if_recover(if_was_set);
+        return 0;
+    }
+
+    futex_unlink(ktcb->futex_w);
+
+    if_recover(if_was_set);
+    return 1;
+}
+
+void futex_rekey(void *pgd, void *old_frm, void *new_frm)
+{
+    futex_waiter_t *w, *moved = NULL, **tail = &moved, **p, **q;
+    int i;
+
+    for (i = 0; i < FUTEX_BUCKETS; i++) {
+        p = &(futex_buckets[i]);
+        while (*p != NULL) {
+            w = *p;
+            if (w->pgd != pgd || GET_ADDRESS(w->key) != old_frm) {
+                p = &(w->next);
+                continue;
+            }
+
+            /* collect them oldest first */
+            *p = w->next;
+            w->next = NULL;
+            *tail = w;
+            tail = &(w->next);
+        }
+    }
+
+    while (moved != NULL) {
+        w = moved;
+        moved = w->next;
+
+        w->key = (unsigned long)new_frm | (w->key & (PAGE_SIZE - 1));
+        w->next = NULL;
+
+        for (q = &(futex_buckets[FUTEX_BUCKET(w->key)]); *q != NULL;
+             q = &((*q)->next))
+            continue;
+        *q = w;
+    }
+}
+
+int futex_frame_busy(void *frm)
+{
+    futex_waiter_t *w;
+    int i;
+
+    for (i = 0; i < FUTEX_BUCKETS; i++) {
+        for (w = futex_buckets[i]; w != NULL; w = w->next) {
+            if (GET_ADDRESS(w->key) == frm)
+                return 1;
+        }
+    }
+
+    return 0;
+}
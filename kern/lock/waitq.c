@@ -0,0 +1,133 @@
+/** @file kern/lock/waitq.c
+ *
+ *  @brief wait queues implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <waitq.h>
+#include <common_include.h>
+#include <timed_queue.h>
+
+static char *tag = "waitq";
+
+/** @brief take an entry out of its queue, interrupts disabled
+ *
+ *  @param e the entry
+ *  @return Void
+ */
+static void waitq_unlink(waitq_entry_t *e)
+{
+    waitq_t *q = e->q;
+
+    if (e->prev != NULL)
+        e->prev->next = e->next;
+    else
+        q->head = e->next;
+
+    if (e->next != NULL)
+        e->next->prev = e->prev;
+    else
+        q->tail = e->prev;
+
+    e->prev = NULL;
+    e->next = NULL;
+    e->q = NULL;
+}
+
+void waitq_init(waitq_t *q)
+{
+    q->head = NULL;
+    q->tail = NULL;
+}
+
+int waitq_empty(waitq_t *q)
+{
+    return q->head == NULL;
+}
+
+void waitq_thread_init(waitq_thread_t *thr)
+{
+    thr->ktcb = running_ktcb;
+    thr->woken = 0;
+    thr->asleep = 0;
+    thr->timed = 0;
+}
+
+void waitq_add(waitq_t *q, waitq_entry_t *e, waitq_thread_t *thr)
+{
+    int if_was_set = if_disable();
+
+    e->thr = thr;
+    e->q = q;
+    e->next = NULL;
+    e->prev = q->tail;
+
+    if (q->tail != NULL)
+        q->tail->next = e;
+    else
+        q->head = e;
+    q->tail = e;
+
+    if_recover(if_was_set);
+}
+
+void waitq_remove(waitq_entry_t *e)
+{
+    int if_was_set = if_disable();
+
+    if (e->q != NULL)
+        waitq_unlink(e);
+
+    if_recover(if_was_set);
+}
+
+void waitq_wake(waitq_t *q)
+{
+    waitq_entry_t *e;
+    waitq_thread_t *thr;
+    int if_was_set = if_disable();
+
+    while ((e = q->head) != NULL) {
+        thr = e->thr;
+        waitq_unlink(e);
+
+        if (thr->woken)
+            continue;
+        thr->woken = 1;
+
+        /* a timed thread the sleep queue already let go of is runnable */
+        if (thr->asleep && (!thr->timed || tq_delete(thr->ktcb) != 0))
+            sched_running_to_runnable(thr->ktcb);
+    }
+
+    if_recover(if_was_set);
+}
+
+int waitq_sleep(waitq_thread_t *thr, int timed, unsigned int deadline)
+{
+    int if_was_set = if_disable();
+    int woken;
+
+    /* a source woke us between the adds and now, don't block */
+    if (!thr->woken) {
+        thr->asleep = 1;
+        thr->timed = timed;
+
+        if (timed)
+            sched_running_to_sleep(thr->ktcb, deadline);
+
+        report_progress(tag, "waitq_sleep: %p blocks", thr->ktcb);
+        cs_save_and_switch(running_ktcb, sched_next());
+
+        thr->asleep = 0;
+        thr->timed = 0;
+    }
+
+    woken = thr->woken;
+    thr->woken = 0;
+
+    if_recover(if_was_set);
+    return woken;
+}
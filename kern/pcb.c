@@ -16,6 +16,8 @@
 #include <asm.h>
 #include <loader.h>
 #include <sched.h>
+#include <stack_region.h>
+#include <console.h>
 
 int tcb_count;
 
@@ -127,6 +129,7 @@ pcb_t *pcb_create(unsigned long pgd, reg_t *regs, pcb_t *parent, ktcb_t *ktcb,
     pcb->pgd = pgd;
 
     pcb->parent = parent;
+    pcb->vt = (parent != NULL) ? parent->vt : 0;
     pcb->exit_status = 0;
     pcb->exited_thread_count = 0;
 
@@ -165,6 +168,8 @@ pcb_t *pcb_create(unsigned long pgd, reg_t *regs, pcb_t *parent, ktcb_t *ktcb,
         return NULL; 
     }
     
+    waitq_init(&(pcb->child_waitq));
+
     /* allocate wait_cond */
     if (cond_init(&(pcb->wait_cond)) != 0) {
         report_error(tag, "pcb_create: failed to init cond");
@@ -174,6 +179,29 @@ pcb_t *pcb_create(unsigned long pgd, reg_t *regs, pcb_t *parent, ktcb_t *ktcb,
         free(pcb);
         return NULL;
     }
+
+    /* allocate stack_mp */
+    if (mutex_init(&(pcb->stack_mp)) != 0) {
+        report_error(tag, "pcb_create: failed to init stack mutex");
+
+        cond_destroy(&(pcb->wait_cond));
+        ht_destroy(pcb->tcb_ht);
+        ht_destroy(pcb->children);
+        free(pcb);
+        return NULL;
+    }
+
+    /* allocate ring_mp */
+    if (mutex_init(&(pcb->ring_mp)) != 0) {
+        report_error(tag, "pcb_create: failed to init ring mutex");
+
+        mutex_destroy(&(pcb->stack_mp));
+        cond_destroy(&(pcb->wait_cond));
+        ht_destroy(pcb->tcb_ht);
+        ht_destroy(pcb->children);
+        free(pcb);
+        return NULL;
+    }
     
     pcb->pid = generate_tid();
 
@@ -181,6 +209,8 @@ pcb_t *pcb_create(unsigned long pgd, reg_t *regs, pcb_t *parent, ktcb_t *ktcb,
     if (tcb_create(pcb, pcb->tcb_ht, regs, pcb->pid, ktcb) == NULL) {
         report_error(tag, "pcb_create: fail to create root tcb");
 
+        mutex_destroy(&(pcb->ring_mp));
+        mutex_destroy(&(pcb->stack_mp));
         cond_destroy(&(pcb->wait_cond));
         ht_destroy(pcb->tcb_ht);
         ht_destroy(pcb->children);
@@ -298,6 +328,20 @@ pcb_t *pcb_update(pcb_t *pcb, unsigned long pgd, reg_t *regs, tid_t tid,
     pcb->new_pages_ht = new_new_pages_ht;
     pcb->tcb_ht = new_tcb_ht;
 
+    /* a new program has a new access pattern */
+    pcb->fault_last = 0;
+    pcb->fault_next = 0;
+    pcb->fault_dir = 0;
+    pcb->fault_window = 0;
+
+    /* the new program registers its own stacks, and ring, and maps the
+     * terminal again if it wants to
+     */
+    stack_region_clear(pcb);
+    pcb->ring = NULL;
+    pcb->ring_entries = 0;
+    vt_release(pcb->pid);
+
     /* clear old structures */
     ht_destroy(old_tcb_ht);
 
@@ -319,8 +363,13 @@ void pcb_free(pcb_t *pcb) {
     /* destroy children ht */
     ht_destroy(pcb->children);
 
+    /* destroy stack regions */
+    stack_region_clear(pcb);
+
     /* destroy locks */
     cond_destroy(&(pcb->wait_cond));
+    mutex_destroy(&(pcb->stack_mp));
+    mutex_destroy(&(pcb->ring_mp));
     
     sched_remove_pcb(pcb);
 
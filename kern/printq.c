@@ -0,0 +1,171 @@
+/** @file kern/printq.c
+ *
+ *  @brief the queue between print and the console, and its worker
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <printq.h>
+#include <mpsc_queue.h>
+#include <waitq.h>
+#include <common_include.h>
+#include <malloc.h>
+
+static char *tag = "printq";
+
+/* a queued print, the node first */
+typedef struct printq_rec {
+    mpsc_node_t n;
+
+    vterm_t *vt;
+    int len;
+    char data[0];
+} printq_rec_t;
+
+static mpsc_queue_t printq;
+
+/* the bytes queued, the records queued and the records drawn so far. Only
+ * the worker writes drawn
+ */
+static int queued_bytes = 0;
+static int queued = 0;
+static volatile int drawn = 0;
+
+/* the worker waits on work_waitq, printq_flush on drawn_waitq */
+static waitq_t work_waitq;
+static waitq_t drawn_waitq;
+
+static int printq_ready = 0;
+
+/** @brief draw a print in the calling thread
+ *
+ *  @param vt the terminal
+ *  @param buf the bytes
+ *  @param len the number of bytes
+ *  @return Void
+ */
+static void printq_draw(vterm_t *vt, const char *buf, int len)
+{
+    mutex_lock(&(vt->print_mp));
+    vt_putbytes(vt, buf, len);
+    mutex_unlock(&(vt->print_mp));
+}
+
+/** @brief the body of the console worker
+ *
+ *  @return never returns
+ */
+static void printq_run(void)
+{
+    waitq_thread_t thr;
+    waitq_entry_t e;
+    printq_rec_t *rec;
+
+    /* context switches run with interrupts off, a fresh thread has no
+     * if_recover to turn them back on
+     */
+    enable_interrupts();
+
+    while (1) {
+        /* get on the queue before looking, so a push in between is not
+         * lost
+         */
+        waitq_thread_init(&thr);
+        waitq_add(&work_waitq, &e, &thr);
+
+        while ((rec = (printq_rec_t *)mpsc_pop(&printq)) != NULL) {
+            printq_draw(rec->vt, rec->data, rec->len);
+
+            xadd(&queued_bytes, -rec->len);
+            free(rec);
+
+            drawn++;
+            waitq_wake(&drawn_waitq);
+        }
+
+        waitq_sleep(&thr, 0, 0);
+        waitq_remove(&e);
+    }
+}
+
+int printq_init(void)
+{
+    mpsc_init(&printq);
+    waitq_init(&work_waitq);
+    waitq_init(&drawn_waitq);
+
+#if PRINTQ_ENABLED
+    if (sched_spawn_kthread(printq_run) == NULL) {
+        report_error(tag, "printq_init: can't start the console worker");
+        return -1;
+    }
+
+    printq_ready = 1;
+#endif
+
+    return 0;
+}
+
+void printq_print(vterm_t *vt, const char *buf, int len)
+{
+    printq_rec_t *rec;
+
+    if (len <= 0)
+        return;
+
+    /* a print bigger than the whole queue would only be a kernel heap
+     * allocation as big as the caller likes, draw it behind the queued ones
+     * in the caller
+     */
+    if (!printq_ready || len > PRINTQ_MAX_BYTES) {
+        printq_flush();
+        printq_draw(vt, buf, len);
+        return;
+    }
+
+    /* don't let a flood of prints eat the kernel heap */
+    if (queued_bytes + len > PRINTQ_MAX_BYTES)
+        printq_flush();
+
+    if ((rec = malloc(sizeof(printq_rec_t) + len)) == NULL) {
+        /* behind the ones queued, in the caller */
+        report_warning(tag, "printq_print: no memory, drawing in place");
+        printq_flush();
+        printq_draw(vt, buf, len);
+        return;
+    }
+
+    rec->vt = vt;
+    rec->len = len;
+    memcpy(rec->data, buf, len);
+
+    xadd(&queued_bytes, len);
+    xadd(&queued, 1);
+
+    mpsc_push(&printq, &(rec->n));
+    waitq_wake(&work_waitq);
+}
+
+void printq_flush(void)
+{
+    waitq_thread_t thr;
+    waitq_entry_t e;
+    int target = queued;
+
+    if (!printq_ready)
+        return;
+
+    while (1) {
+        waitq_thread_init(&thr);
+        waitq_add(&drawn_waitq, &e, &thr);
+
+        if (drawn - target >= 0)
+            break;
+
+        waitq_sleep(&thr, 0, 0);
+        waitq_remove(&e);
+    }
+
+    waitq_remove(&e);
+}
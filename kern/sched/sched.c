@@ -19,6 +19,7 @@
 #include <timed_queue.h>
 #include <reporter.h>
 #include <if_flag.h>
+#include <futex.h>
 
 /* the runnable queue of KTCB */
 st_queue runnable_ktcbs;
@@ -177,6 +178,12 @@ pcb_t *sched_find_pcb(int pid) {
 int sched_delete(ktcb_t *ktcb) {
     int if_was_set = if_disable();
 
+    /* blocked in futex_wait, and in the sleep queue only with a timeout */
+    if (futex_cancel(ktcb) && !tq_find(ktcb)) {
+        if_recover(if_was_set);
+        return 0;
+    }
+
     if (sched_runnable_to_running(ktcb->tcb->tid) != NULL) {
         if_recover(if_was_set);
         return 0;
@@ -233,6 +240,46 @@ void sched_run() {
     }
 }
 
+ktcb_t *sched_spawn_kthread(void (*fn)(void)) {
+
+    pcb_t *pcb = sched_ktcb->tcb->pcb;
+
+    reg_t *regs = calloc(1, sizeof(reg_t));
+    if (regs == NULL) {
+        report_error(tag, "sched_spawn_kthread: reg calloc failed");
+        return NULL;
+    }
+
+    ktcb_t *ktcb = kthr_alloc();
+    if (ktcb == NULL) {
+        report_error(tag, "sched_spawn_kthread: kthr_alloc failed");
+        free(regs);
+        return NULL;
+    }
+
+    /* kernel threads belong to the scheduler's process */
+    if (tcb_create(pcb, pcb->tcb_ht, regs, generate_tid(), ktcb) == NULL) {
+        report_error(tag, "sched_spawn_kthread: tcb_create failed");
+        kthr_free(ktcb);
+        free(regs);
+        return NULL;
+    }
+
+    unsigned long esp0 = ktcb->regs->esp0;
+
+    /* fn never returns, so its return address is never used */
+    *(unsigned long *)(esp0 - 4) = 0;
+
+    /* set_ebp_and_switch pops the ebp slot and returns into fn */
+    *(unsigned long *)(esp0 - 8) = (unsigned long)fn;
+    *(unsigned long *)(esp0 - 12) = 0;
+    ktcb->regs->ebp = esp0 - 12;
+
+    sched_running_to_runnable(ktcb);
+
+    return ktcb;
+}
+
 void sched_add_child(pcb_t *child) {
 
     pcb_t *pcb = sched_ktcb->tcb->pcb;
@@ -0,0 +1,53 @@
+/** @file kern/blit_cells.c
+ *
+ *  @brief blit_cells syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+
+static char *tag = "blit_cells";
+
+int blit_cells_handler(void *args) {
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+
+    if (vm_mem_region_check(pcb, (void *)pcb->pgd, args, 20) < 0) {
+        report_error(tag, "arguments not accessible, exit");
+        return -1;
+    }
+
+    int row = *(int *)args;
+    int col = *(int *)(args + 4);
+    int w = *(int *)(args + 8);
+    int h = *(int *)(args + 12);
+    uint16_t *cells = *(uint16_t **)(args + 16);
+
+    if (row < 0 || col < 0 || w <= 0 || h <= 0 ||
+        row + h > CONSOLE_FB_ROWS || col + w > CONSOLE_FB_COLS) {
+        report_error(tag, "rectangle not on the screen, exit");
+        return -1;
+    }
+
+    if (vm_mem_region_check(pcb, (void *)pcb->pgd, cells,
+                            w * h * sizeof(uint16_t)) < 0) {
+        report_error(tag, "can't read from cells, exit");
+        return -1;
+    }
+
+    /* drawn over what the prints before it drew, not under */
+    printq_flush();
+
+    if (vt_blit(vt_running(), row, col, w, h, cells) != 0) {
+        report_error(tag, "can't blit, exit");
+        return -1;
+    }
+
+    report_progress(tag, "exit");
+    return 0;
+}
@@ -0,0 +1,46 @@
+/** @file kern/console_map.c
+ *
+ *  @brief console_map syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <console_fb.h>
+
+static char *tag = "console_map";
+
+int console_map_handler(int map) {
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    void *pgd = (void *)pcb->pgd;
+    vterm_t *vt = vt_get(pcb->vt);
+
+    /* it owns one terminal at most, the one it is on now */
+    vt_release(pcb->pid);
+    console_fb_unmap(pgd);
+
+    if (!map) {
+        report_progress(tag, "process %d unmapped, exit", pcb->pid);
+        return 0;
+    }
+
+    /* the owner starts from what the prints before it drew */
+    printq_flush();
+
+    if (vt_map(vt, pcb->pid) != 0) {
+        report_error(tag, "terminal %d owned by another process, exit",
+                     pcb->vt);
+        return -1;
+    }
+
+    console_fb_map(pgd, pcb->vt, vt->cells);
+
+    report_progress(tag, "process %d mapped terminal %d, exit", pcb->pid,
+                    pcb->vt);
+    return 0;
+}
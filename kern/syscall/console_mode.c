@@ -0,0 +1,40 @@
+/** @file kern/console_mode.c
+ *
+ *  @brief console_mode syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <serial_driver.h>
+
+static char *tag = "console_mode";
+
+int console_mode_handler(int mode) {
+    report_progress(tag, "entry");
+
+    int old;
+
+    if (mode >= CONSOLE_SERIAL_OFF && mode <= CONSOLE_SERIAL_REDIRECT) {
+        old = serial_set_console_mode(mode - CONSOLE_SERIAL_OFF);
+        if (old < 0) {
+            report_error(tag, "can't set serial mode %d, exit", mode);
+            return -1;
+        }
+
+        report_progress(tag, "serial mode %d, exit", mode);
+        return CONSOLE_SERIAL_OFF + old;
+    }
+
+    old = console_set_mode(mode);
+    if (old < 0) {
+        report_error(tag, "no console mode %d, exit", mode);
+        return -1;
+    }
+
+    report_progress(tag, "console mode %d, exit", mode);
+    return old;
+}
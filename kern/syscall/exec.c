@@ -12,6 +12,40 @@
 
 static char *tag = "exec";
 
+int check_exec_args(pcb_t *pcb, void *pgd, char *execname, char **argvec) {
+    /* check execname array */
+    if (vm_mem_array_check(pcb, pgd, 1, execname) < 0) {
+        report_error(tag, "execname not accessible");
+        return 0;
+    }
+
+    /* check argvec array */
+    if (vm_mem_array_check(pcb, pgd, 4, argvec) < 0) {
+        report_error(tag, "argvec not accessible");
+        return 0;
+    }
+
+    /* check inside argvec */
+    int idx = 0;
+    char *arg = *argvec;
+    while (arg != NULL) {
+        if (vm_mem_array_check(pcb, pgd, 1, arg) < 0) {
+            report_error(tag, "argvec elem not accessible");
+            return 0;
+        }
+        idx++;
+        arg = *(argvec + idx);
+    }
+
+    /* check that argvec[0] is filename */
+    if (argvec[0] == NULL || strcmp(execname, argvec[0]) != 0) {
+        report_error(tag, "argvec[0] is not execname");
+        return 0;
+    }
+
+    return 1;
+}
+
 int exec_handler(void *args) {
 
     report_progress(tag, "entry");
@@ -39,36 +73,8 @@ int exec_handler(void *args) {
     char *execname = *(char **)args;
     char **argvec = *(char ***)(args + 4);
 
-    /* check execname array */
-    if (vm_mem_array_check(pcb, pgd, 1, execname) < 0) {
-        report_error(tag, "exec_handler: execname not accessible, exit");
-        return -1;
-    }
-
-    /* check argvec array */
-    if (vm_mem_array_check(pcb, pgd, 4, argvec) < 0) {
-        report_error(tag, "exec_handler: argvec not accessible, exit");
-        return -1;
-    }
-
-    /* check inside argvec */
-    int idx = 0;
-    char *arg = *argvec;
-    while (arg != NULL) {
-        if (vm_mem_array_check(pcb, pgd, 1, arg) < 0) {
-            report_error(tag, 
-                        "exec_handler: argvec elem not accessible, exit");
-
-            return -1;
-        }
-        idx++;
-        arg = *(argvec + idx);
-    }
-
-    /* check that argvec[0] is filename */
-    if (strcmp(execname, argvec[0]) != 0) {
-        report_error(tag, "wrong input, exit");
-
+    if (!check_exec_args(pcb, pgd, execname, argvec)) {
+        report_error(tag, "exec_handler: bad execname or argvec, exit");
         return -1;
     }
 
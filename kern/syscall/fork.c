@@ -9,6 +9,7 @@
 #include <syscall.h>
 
 #include <common_include.h>
+#include <stack_region.h>
 
 static char *tag = "fork";
 
@@ -52,6 +53,9 @@ void fork_handler() {
         return;
     }
 
+    /* the child lives under the same frame limit */
+    PGD_ACCT(new_pgd)->max_frames = PGD_ACCT(pgd)->max_frames;
+
     /* COW pages */
     if (vm_ref_copy((void *)pgd, (void *)new_pgd, 1) != 0) {
         report_error(tag, "can't copy new pgd, exit");
@@ -91,6 +95,13 @@ void fork_handler() {
         return;
     }
 
+    /* the child runs on a copy of the same stack */
+    if (stack_region_copy(pcb, tcb->tid, new_pcb, new_pcb->pid) != 0)
+        report_error(tag, "child stack will not grow on its own");
+
+    /* and has a copy of the ring at the same address */
+    new_pcb->ring = pcb->ring;
+    new_pcb->ring_entries = pcb->ring_entries;
 
     report_progress(tag, "setting up child...");
     /* set up new ktcb stack */
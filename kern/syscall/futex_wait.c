@@ -0,0 +1,33 @@
+/** @file kern/futex_wait.c
+ *
+ *  @brief futex_wait syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <futex.h>
+
+static char *tag = "futex_wait";
+
+int futex_wait_handler(void *args) {
+
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    void *pgd = (void *)pcb->pgd;
+
+    if (vm_mem_region_check(pcb, pgd, args, 12) < 0) {
+        report_error(tag, "futex_wait: arguments not accessible, exit");
+        return -1;
+    }
+
+    int *addr = *(int **)args;
+    int expected = *(int *)(args + 4);
+    int timeout = *(int *)(args + 8);
+
+    return futex_wait(addr, expected, timeout);
+}
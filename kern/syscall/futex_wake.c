@@ -0,0 +1,32 @@
+/** @file kern/futex_wake.c
+ *
+ *  @brief futex_wake syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <futex.h>
+
+static char *tag = "futex_wake";
+
+int futex_wake_handler(void *args) {
+
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    void *pgd = (void *)pcb->pgd;
+
+    if (vm_mem_region_check(pcb, pgd, args, 8) < 0) {
+        report_error(tag, "futex_wake: arguments not accessible, exit");
+        return -1;
+    }
+
+    int *addr = *(int **)args;
+    int n = *(int *)(args + 4);
+
+    return futex_wake(addr, n);
+}
@@ -35,6 +35,9 @@ int get_cursor_pos_handler(void *args) {
         return -1;
     }
 
+    /* where the prints before it left the cursor */
+    printq_flush();
+
     get_cursor(row, col);
 
     report_progress(tag, "exit");
@@ -0,0 +1,39 @@
+/** @file kern/get_mem_usage.c
+ *
+ *  @brief get_mem_usage syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <syscall_ext.h>
+
+static char *tag = "get_mem_usage";
+
+int get_mem_usage_handler(mem_usage_t *usage) {
+
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    vm_acct_t *acct = PGD_ACCT(pcb->pgd);
+
+    if (vm_mem_region_check(pcb, (void *)pcb->pgd, (void *)usage, 
+                            sizeof(mem_usage_t)) != 1) {
+        report_error(tag, "get_mem_usage: usage not writable, exit");
+        return -1;
+    }
+
+    usage->resident = acct->resident;
+    usage->shared = acct->shared;
+    usage->swapped = acct->swapped;
+    usage->pt_pages = acct->pt_pages;
+    usage->max_frames = acct->max_frames;
+    usage->faults_saved = pcb->faults_saved;
+    usage->faults_saved_all = pgfault_get_faults_saved();
+
+    report_progress(tag, "exit");
+    return 0;
+}
@@ -4,13 +4,30 @@
  *
  *  @author Hingon Miu (hmiu@andrew.cmu.edu)
  *  @author An Wu (anwu@andrew.cmu.edu)
- *  @bug not implemented
  */
 
 #include <syscall_handler.h>
 
 #include <common_include.h>
 
+static char *tag = "getchar";
+
 char getchar_handler() {
-    return 0;
+    report_progress(tag, "getchar_handler: entry");
+
+    vterm_t *vt = vt_running();
+    char c;
+
+    /* the prompt printed before comes ahead of the echo */
+    printq_flush();
+
+    /* what was typed before we came, if we are on the screen */
+    if (vt == vt_foreground()) {
+        fill_cons(vt);
+    }
+
+    /* waits behind the readlines and getchars that came first */
+    ldisc_read(&(vt->in), &c, 1);
+
+    return c;
 }
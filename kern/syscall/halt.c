@@ -9,11 +9,16 @@
 #include <syscall_handler.h>
 
 #include <common_include.h>
+#include <zswap.h>
 
 static char *tag = "halt";
 
 void halt_handler() {
     report_progress(tag, "entry");
+
+    /* leave the swap pool numbers on the simics console */
+    zswap_report();
+
     disable_interrupts();
 
     sim_call(SIM_HALT);
@@ -9,6 +9,9 @@
 #include <syscall_handler.h>
 
 #include <common_include.h>
+#include <zswap.h>
+#include <reaper.h>
+#include <stack_region.h>
 
 static char *tag = "new_pages";
 
@@ -39,8 +42,19 @@ int new_pages_handler(void *args) {
         return -1;
     }
 
-    /* check if there are enough frames left */
-    if (len > frame_get_count() * PAGE_SIZE) {
+    /* check if the frame limit of the process allows it */
+    if (!pgd_acct_may_grow(pgd, len / PAGE_SIZE)) {
+        report_error(tag, "len is over the frame limit of the process");
+        return -1;
+    }
+
+    /* check if there are enough frames left. If not, finish the teardown
+     * of exited processes, then swap out cold pages
+     */
+    int short_frames = len / PAGE_SIZE - frame_get_count();
+    if (short_frames > 0 && reaper_drain() > 0)
+        short_frames = len / PAGE_SIZE - frame_get_count();
+    if (short_frames > 0 && zswap_reclaim(short_frames) < short_frames) {
         report_error(tag, "len is more than available frames");
         return -1;
     }
@@ -52,6 +66,12 @@ int new_pages_handler(void *args) {
         return -1;
     }
 
+    /* check if it reaches into the stack of a thread */
+    if (stack_region_overlaps(pcb, (unsigned long)base, len)) {
+        report_error(tag, "base reaches into a stack region, exit");
+        return -1;
+    }
+
     /* check if any portion was allocated before */
     int remain = len;
     void *linear_addr = base;
@@ -79,6 +99,13 @@ int new_pages_handler(void *args) {
 
     if (track_pages_allocated(running_ktcb->tcb->pcb, base, len) != 0) {
         report_error(tag, "failed to track allocated pages, exit");
+
+        /* nobody could ever remove_pages them, give them back now */
+        for (linear_addr = base; linear_addr < base + len; 
+                linear_addr += PAGE_SIZE)
+            pgd_unmap_page(pgd, linear_addr);
+        check_and_delete_pt(pgd, base, len);
+        set_cr3((unsigned long)pgd);
         return -1;
     }
 
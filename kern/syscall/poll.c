@@ -0,0 +1,158 @@
+/** @file kern/poll.c
+ *
+ *  @brief poll syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <waitq.h>
+
+static char *tag = "poll";
+
+/* whether tick a is at or past tick b, the ticks wrap */
+#define TICK_REACHED(a, b) ((int)((a) - (b)) >= 0)
+
+/** @brief set revents of every event and count the ready ones
+ *
+ *  @param ev the events
+ *  @param n the number of events
+ *  @param pcb the polling process
+ *  @param vt its terminal
+ *  @return the events ready
+ */
+static int poll_check(poll_event_t *ev, int n, pcb_t *pcb, vterm_t *vt)
+{
+    int i, ready = 0;
+
+    for (i = 0; i < n; i++) {
+        switch (ev[i].type) {
+            case POLL_CONSOLE:
+                /* what was typed before we came, if we are on the screen */
+                if (vt == vt_foreground())
+                    fill_cons(vt);
+                ev[i].revents = ldisc_readable(&(vt->in));
+                break;
+
+            case POLL_CHILD:
+                /* no children is ready too, wait returns right away */
+                mutex_lock(&(pcb->children->mp));
+                ev[i].revents = ht_empty(pcb->children) ||
+                    ht_find(pcb->children, pcb_all_thr_exited) != NULL;
+                mutex_unlock(&(pcb->children->mp));
+                break;
+
+            case POLL_TIMER:
+                ev[i].revents = TICK_REACHED(ticks_global, ev[i].arg);
+                break;
+        }
+
+        ready += ev[i].revents;
+    }
+
+    return ready;
+}
+
+int poll_handler(void *args) {
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    vterm_t *vt = vt_running();
+
+    if (vm_mem_region_check(pcb, (void *)pcb->pgd, args, 12) < 0) {
+        report_error(tag, "arguments not accessible, exit");
+        return -1;
+    }
+
+    poll_event_t *events = *(poll_event_t **)args;
+    int n = *(int *)(args + 4);
+    int timeout = *(int *)(args + 8);
+
+    if (n < 0 || n > POLL_MAX_EVENTS) {
+        report_error(tag, "invalid n %d, exit", n);
+        return -1;
+    }
+
+    if (n > 0 && vm_mem_region_check(pcb, (void *)pcb->pgd, events,
+                                     n * sizeof(poll_event_t)) != 1) {
+        report_error(tag, "can't write to events, exit");
+        return -1;
+    }
+
+    poll_event_t ev[POLL_MAX_EVENTS];
+    int want_console = 0, want_child = 0;
+    int timed = (timeout >= 0);
+    unsigned int deadline = timed ? ticks_global + timeout : 0;
+    int i;
+
+    memcpy(ev, events, n * sizeof(poll_event_t));
+
+    for (i = 0; i < n; i++) {
+        switch (ev[i].type) {
+            case POLL_CONSOLE:
+                want_console = 1;
+                break;
+
+            case POLL_CHILD:
+                want_child = 1;
+                break;
+
+            case POLL_TIMER:
+                /* wake up for the earliest timer too */
+                if (!timed || !TICK_REACHED(ev[i].arg, deadline))
+                    deadline = ev[i].arg;
+                timed = 1;
+                break;
+
+            default:
+                report_error(tag, "invalid event type %d, exit", ev[i].type);
+                return -1;
+        }
+    }
+
+    waitq_thread_t thr;
+    waitq_entry_t console_e, child_e;
+    int ready;
+
+    /* the prompt printed before comes ahead of the echo */
+    if (want_console)
+        printq_flush();
+
+    while (1) {
+        /* get on the queues before looking, so a wake in between is not
+         * lost
+         */
+        waitq_thread_init(&thr);
+        if (want_console)
+            waitq_add(&(vt->in.pollers), &console_e, &thr);
+        if (want_child)
+            waitq_add(&(pcb->child_waitq), &child_e, &thr);
+
+        ready = poll_check(ev, n, pcb, vt);
+
+        if (ready > 0 || timeout == 0 ||
+            (timed && TICK_REACHED(ticks_global, deadline)))
+            break;
+
+        waitq_sleep(&thr, timed, deadline);
+
+        if (want_console)
+            waitq_remove(&console_e);
+        if (want_child)
+            waitq_remove(&child_e);
+    }
+
+    if (want_console)
+        waitq_remove(&console_e);
+    if (want_child)
+        waitq_remove(&child_e);
+
+    for (i = 0; i < n; i++)
+        events[i].revents = ev[i].revents;
+
+    report_progress(tag, "exit, %d ready", ready);
+    return ready;
+}
@@ -9,19 +9,8 @@
 #include <common_include.h>
 #include <syscall.h>
 
-mutex_t print_mp;
-
 static char *tag = "print";
 
-int print_init() {
-    if (mutex_init(&print_mp) != 0) {
-        report_error(tag, "print_init: mp init failed");
-        return -1;
-    }
-    
-    return 0;
-}
-
 int print_handler(void *args) {
     report_progress(tag, "entry");
 
@@ -44,16 +33,10 @@ int print_handler(void *args) {
         return -1;
     }
 
-    char c;
-
-    mutex_lock(&print_mp);
-    while (len != 0) {
-        c = *(buf);
-        putbyte(c);
-        len--;
-        buf++;
-    }
-    mutex_unlock(&print_mp);
+    /* copied and queued whole, the console worker draws it. Nobody waits
+     * for the screen, not even this print
+     */
+    printq_print(vt_running(), buf, len);
 
     report_progress(tag, "exit");
 
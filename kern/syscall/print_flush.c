@@ -0,0 +1,22 @@
+/** @file kern/print_flush.c
+ *
+ *  @brief print_flush syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+
+static char *tag = "print_flush";
+
+int print_flush_handler() {
+    report_progress(tag, "entry");
+
+    printq_flush();
+
+    report_progress(tag, "exit");
+    return 0;
+}
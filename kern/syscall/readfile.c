@@ -9,7 +9,7 @@
 #include <syscall_handler.h>
 
 #include <common_include.h>
-#include <exec2obj.h>
+#include <exec_index.h>
 
 static char *tag = "readfile";
 
@@ -44,37 +44,23 @@ int readfile_handler(void *args) {
         return -1;
     }
 
-    /* didn't use loader here, because we need to check offset and file 
+    /* didn't use getbytes here, because we need to check offset and file 
      * length
      */
-    int i;
-    for (i = 0; i < exec2obj_userapp_count; i++) {
-        if (strcmp(filename, exec2obj_userapp_TOC[i].execname) == 0)
-            break;
-    }
-
-    if (i == exec2obj_userapp_count) {
+    const exec_entry_t *e = exec_index_lookup(filename);
+    if (e == NULL) {
         report_error(tag, "can't find filename in table of contents, exit");
         return -1;
     }
 
-    int execlen = exec2obj_userapp_TOC[i].execlen;
-
-    if (offset >= execlen) {
+    if (offset >= e->len) {
         report_error(tag, "offset is larger than execlen, exit");
         return -1;
     }
 
-    int length = execlen - offset;
-    char *ret = memcpy(buf, exec2obj_userapp_TOC[i].execbytes + offset,
-                       length > count ? count : length);
-
-    if (ret != buf) {
-        report_error(tag, "memcpy failed, exit");
-        return -1;
-    }
+    int length = exec_index_read(e, offset, count, buf);
 
     report_progress(tag, "exit");
-    return length > count ? count : length;
+    return length;
 }
 
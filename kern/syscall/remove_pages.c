@@ -24,24 +24,25 @@ int remove_pages_handler(void *base) {
 
     void *linear_addr = base;
     void *pgd = (void *)get_cr3();
-    void *frm;
+    int remain = len;
 
-    /* remove frames */
-    while (len != 0) {
-        if ((frm = pt_entry_delete(pgd, linear_addr, 0)) == NULL) {
+    /* remove frames, a frame still shared copy-on-write after a fork only
+     * loses this reference
+     */
+    while (remain != 0) {
+        if (pgd_unmap_page(pgd, linear_addr) != 0) {
             report_error(tag, "cant find pt entry in pgd, exit");
+            set_cr3((unsigned long)pgd);
             return -1;
         }
-        
-        mutex_lock(&(frm_mp));
-        frame_free(frm);
-        mutex_unlock(&(frm_mp));
 
-        set_cr3((unsigned long)pgd);
         linear_addr += PAGE_SIZE;
-        len -= PAGE_SIZE;
+        remain -= PAGE_SIZE;
     }
 
+    /* one flush for the whole region */
+    set_cr3((unsigned long)pgd);
+
     /* remove pt if possible */
     check_and_delete_pt(pgd, base, len);
 
@@ -0,0 +1,116 @@
+/** @file kern/ring_enter.c
+ *
+ *  @brief ring_enter syscall implementation
+ *
+ *  Each submission is run by the handler its SYS_ number has in the
+ *  SYSENTER table, given the arg the stub would have put in esi, so the
+ *  handlers check their arguments as if called directly.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <syscall_ext.h>
+#include <sysenter.h>
+
+static char *tag = "ring_enter";
+
+/** @brief check if a syscall may be submitted through a ring. The ones
+ *         that never return, or replace the thread, may not.
+ *
+ *  @param op the SYS_ number
+ *  @return 1 if it may, 0 if not
+ */
+static int ring_op_allowed(int op)
+{
+    switch (op) {
+    case SYS_PRINT:
+    case SYS_NEW_PAGES:
+    case SYS_REMOVE_PAGES:
+    case SYS_READFILE:
+    case SYS_SET_TERM_COLOR:
+    case SYS_SET_CURSOR_POS:
+    case SYS_GET_CURSOR_POS:
+    case SYS_GETTID:
+    case SYS_GET_TICKS:
+    case SYS_YIELD:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+int ring_enter_handler(int n) {
+
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    void *pgd = (void *)pcb->pgd;
+
+    if (n < 0) {
+        report_error(tag, "ring_enter: n is %d, exit", n);
+        return -1;
+    }
+
+    /* one batch at a time, the indexes live in the ring */
+    mutex_lock(&(pcb->ring_mp));
+
+    ring_t *ring = pcb->ring;
+    unsigned int mask = pcb->ring_entries - 1;
+
+    if (ring == NULL) {
+        mutex_unlock(&(pcb->ring_mp));
+        report_error(tag, "ring_enter: no ring registered, exit");
+        return -1;
+    }
+
+    /* the ring may have been unmapped since ring_setup */
+    if (vm_mem_region_check(pcb, pgd, ring, 
+                            RING_SIZE(pcb->ring_entries)) != 1) {
+        mutex_unlock(&(pcb->ring_mp));
+        report_error(tag, "ring_enter: ring %p not writable, exit", ring);
+        return -1;
+    }
+
+    ring_sqe_t *sqes = RING_SQES(ring);
+    ring_cqe_t *cqes = RING_CQES(ring, pcb->ring_entries);
+
+    int done;
+    for (done = 0; done < n; done++) {
+        /* submission queue empty, or completion queue full */
+        if (ring->sq_head == ring->sq_tail ||
+            ring->cq_tail - ring->cq_head > mask)
+            break;
+
+        ring_sqe_t sqe = sqes[ring->sq_head & mask];
+        ring->sq_head++;
+
+        int res = -1;
+        if (ring_op_allowed(sqe.op))
+            res = sysenter_table[sqe.op]((void *)sqe.arg);
+        else
+            report_error(tag, "ring_enter: op %d not allowed", sqe.op);
+
+        /* the entry may have unmapped the ring itself */
+        if (sqe.op == SYS_REMOVE_PAGES &&
+            vm_mem_region_check(pcb, pgd, ring, 
+                                RING_SIZE(pcb->ring_entries)) != 1) {
+            report_error(tag, "ring_enter: ring %p got unmapped", ring);
+            done++;
+            break;
+        }
+
+        ring_cqe_t *cqe = &(cqes[ring->cq_tail & mask]);
+        cqe->user_data = sqe.user_data;
+        cqe->res = res;
+        ring->cq_tail++;
+    }
+
+    mutex_unlock(&(pcb->ring_mp));
+
+    report_progress(tag, "ran %d entries, exit", done);
+    return done;
+}
@@ -0,0 +1,61 @@
+/** @file kern/ring_setup.c
+ *
+ *  @brief ring_setup syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <syscall_ext.h>
+
+static char *tag = "ring_setup";
+
+int ring_setup_handler(void *args) {
+
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    void *pgd = (void *)pcb->pgd;
+
+    if (vm_mem_region_check(pcb, pgd, args, 8) < 0) {
+        report_error(tag, "ring_setup: arguments not accessible, exit");
+        return -1;
+    }
+
+    ring_t *ring = *(ring_t **)args;
+    int entries = *(int *)(args + 4);
+
+    /* unregister */
+    if (ring == NULL) {
+        mutex_lock(&(pcb->ring_mp));
+        pcb->ring = NULL;
+        pcb->ring_entries = 0;
+        mutex_unlock(&(pcb->ring_mp));
+
+        report_progress(tag, "ring unregistered, exit");
+        return 0;
+    }
+
+    if (entries <= 0 || entries > RING_MAX_ENTRIES ||
+        (entries & (entries - 1)) != 0) {
+        report_error(tag, "ring_setup: %d entries, exit", entries);
+        return -1;
+    }
+
+    if (((unsigned long)ring & 3) != 0 ||
+        vm_mem_region_check(pcb, pgd, ring, RING_SIZE(entries)) != 1) {
+        report_error(tag, "ring_setup: ring %p not writable, exit", ring);
+        return -1;
+    }
+
+    mutex_lock(&(pcb->ring_mp));
+    pcb->ring = ring;
+    pcb->ring_entries = entries;
+    mutex_unlock(&(pcb->ring_mp));
+
+    report_progress(tag, "ring %p with %d entries, exit", ring, entries);
+    return 0;
+}
@@ -25,6 +25,10 @@ int set_cursor_pos_handler(void *args) {
 
     int row = *(int *)args;
     int col = *(int *)(args + 4);
+
+    /* the prints before it go where the cursor was */
+    printq_flush();
+
     int temp = set_cursor(row, col);
 
     report_progress(tag, "exit");
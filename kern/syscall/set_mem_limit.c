@@ -0,0 +1,29 @@
+/** @file kern/set_mem_limit.c
+ *
+ *  @brief set_mem_limit syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+
+static char *tag = "set_mem_limit";
+
+int set_mem_limit_handler(int frames) {
+
+    report_progress(tag, "entry");
+
+    if (frames < 0) {
+        report_error(tag, "set_mem_limit: negative limit %d, exit", frames);
+        return -1;
+    }
+
+    /* a limit below the current usage only stops further growth */
+    PGD_ACCT(running_ktcb->tcb->pcb->pgd)->max_frames = frames;
+
+    report_progress(tag, "exit");
+    return 0;
+}
@@ -15,6 +15,9 @@ static char *tag = "set_term_color";
 int set_term_color_handler(int color) {
     report_progress(tag, "entry");
 
+    /* the prints before it keep their color */
+    printq_flush();
+
     int temp = set_term_color(color);
 
     report_progress(tag, "exit");
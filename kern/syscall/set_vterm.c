@@ -0,0 +1,30 @@
+/** @file kern/set_vterm.c
+ *
+ *  @brief set_vterm syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+
+static char *tag = "set_vterm";
+
+int set_vterm_handler(int vt) {
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+
+    if (vt_get(vt) == NULL) {
+        report_error(tag, "no terminal %d, exit", vt);
+        return -1;
+    }
+
+    int old = pcb->vt;
+    pcb->vt = vt;
+
+    report_progress(tag, "process %d on terminal %d, exit", pcb->pid, vt);
+    return old;
+}
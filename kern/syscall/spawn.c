@@ -0,0 +1,91 @@
+/** @file kern/spawn.c
+ *
+ *  @brief spawn syscall implementation
+ *
+ *  spawn loads a program into a brand new process, a child of the caller,
+ *  without copying the caller's address space and kernel stack first like
+ *  fork followed by exec does.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+
+static char *tag = "spawn";
+
+int spawn_handler(void *args) {
+
+    report_progress(tag, "entry");
+
+    ktcb_t *ktcb = running_ktcb;
+    pcb_t *pcb = ktcb->tcb->pcb;
+    void *pgd = (void *)pcb->pgd;
+
+    /* check args */
+    if (vm_mem_region_check(pcb, pgd, args, 8) < 0) {
+        report_error(tag, "spawn_handler: arguments not accessible, exit");
+        return -1;
+    }
+
+    char *execname = *(char **)args;
+    char **argvec = *(char ***)(args + 4);
+
+    if (!check_exec_args(pcb, pgd, execname, argvec)) {
+        report_error(tag, "spawn_handler: bad execname or argvec, exit");
+        return -1;
+    }
+
+    ktcb_t *new_ktcb;
+    if ((new_ktcb = kthr_alloc()) == NULL) {
+        report_error(tag, "kthr_alloc failed, exit");
+        return -1;
+    }
+
+    /* load the program into a new process. load_prog leaves cr3 on the
+     * new pgd (or the kernel one on error), so switch back after
+     */
+    pcb_t *new_pcb = load_prog(execname, argvec, NULL, 0, new_ktcb);
+    set_cr3((unsigned long)pgd);
+
+    if (new_pcb == NULL) {
+        report_error(tag, "spawn failed, file not loadable, exit");
+
+        kthr_free(new_ktcb);
+        return -1;
+    }
+
+    /* the frame limit and the terminal are inherited like with fork, the
+     * child was loaded without a parent
+     */
+    PGD_ACCT(new_pcb->pgd)->max_frames = PGD_ACCT(pgd)->max_frames;
+    new_pcb->vt = pcb->vt;
+
+    setup_exec_stack(new_ktcb);
+
+    /* make child relation and schedule child */
+    report_progress(tag, "make new process %d child of process %d", 
+                    new_pcb->pid, pcb->pid);
+
+    new_pcb->parent = pcb;
+
+    mutex_lock(&(pcb->children->mp));
+    ht_insert(pcb->children, new_pcb->pid, (void *)new_pcb);
+    mutex_unlock(&(pcb->children->mp));
+
+    int pid = new_pcb->pid;
+
+    int if_was_set = if_disable();
+
+    if (sched_running_to_runnable(ktcb) != 0)
+        report_error(tag, "cannot add to runnable queue");
+
+    cs_save_and_switch(ktcb, new_ktcb);
+
+    if_recover(if_was_set);
+
+    report_progress(tag, "spawned process %d, exit", pid);
+    return pid;
+}
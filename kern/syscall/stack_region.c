@@ -0,0 +1,40 @@
+/** @file kern/stack_region.c
+ *
+ *  @brief stack_region syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <stack_region.h>
+
+static char *tag = "stack_region";
+
+int stack_region_handler(void *args) {
+
+    report_progress(tag, "entry");
+
+    tcb_t *tcb = running_ktcb->tcb;
+    pcb_t *pcb = tcb->pcb;
+
+    if (vm_mem_region_check(pcb, (void *)pcb->pgd, args, 16) < 0) {
+        report_error(tag, "stack_region: arguments not accessible, exit");
+        return -1;
+    }
+
+    unsigned long hi = *(unsigned long *)args;
+    unsigned long lo = *(unsigned long *)(args + 4);
+    int max_len = *(int *)(args + 8);
+    int guard_len = *(int *)(args + 12);
+
+    if (stack_region_set(pcb, tcb->tid, hi, lo, max_len, guard_len) != 0) {
+        report_error(tag, "stack_region: can't set stack region, exit");
+        return -1;
+    }
+
+    report_progress(tag, "exit");
+    return 0;
+}
@@ -9,6 +9,7 @@
 #include <common_include.h>
 
 #include <syscall.h>
+#include <sysenter.h>
 
 static char *tag = "swexn";
 
@@ -152,6 +153,7 @@ int swexn_handler(void *args) {
 
         disable_interrupts();
         set_esp0(ktcb->regs->esp0);
+        sysenter_set_esp0(ktcb->regs->esp0);
         move_regs_and_mode_switch(newureg->edi, newureg->esi, newureg->ebp,
                                 newureg->ebx, newureg->edx, newureg->ecx,
                                 newureg->eax,
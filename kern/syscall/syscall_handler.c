@@ -11,10 +11,6 @@
 #include <common_include.h>
 
 int syscall_init() {
-    if (print_init() != 0) {
-        report_error("syscall", "syscall_init: print_init failed");
-        return -1;
-    }
     return 0;
 }
 
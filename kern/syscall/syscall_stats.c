@@ -0,0 +1,66 @@
+/** @file kern/syscall_stats.c
+ *
+ *  @brief syscall_stats syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <malloc.h>
+#include <syscall_stats.h>
+
+static char *tag = "syscall_stats";
+
+int syscall_stats_handler(void *args) {
+
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+    void *pgd = (void *)pcb->pgd;
+
+    if (vm_mem_region_check(pcb, pgd, args, 12) < 0) {
+        report_error(tag, "syscall_stats: arguments not accessible, exit");
+        return -1;
+    }
+
+    int pid = *(int *)args;
+    syscall_stat_t *buf = *(syscall_stat_t **)(args + 4);
+    int n = *(int *)(args + 8);
+
+    if (pid < 0 || n < 0) {
+        report_error(tag, "syscall_stats: bad pid %d or count %d, exit",
+                     pid, n);
+        return -1;
+    }
+
+    if (n > SYSCALL_STAT_NSYS)
+        n = SYSCALL_STAT_NSYS;
+
+    if (n > 0 && vm_mem_region_check(pcb, pgd, buf,
+                                     n * sizeof(syscall_stat_t)) != 1) {
+        report_error(tag, "syscall_stats: buf not writable, exit");
+        return -1;
+    }
+
+    /* snapshot first, buf may fault */
+    syscall_stat_t *stats = malloc(SYSCALL_STAT_NSYS * sizeof(syscall_stat_t));
+    if (stats == NULL) {
+        report_error(tag, "syscall_stats: can't alloc snapshot, exit");
+        return -1;
+    }
+
+    if (syscall_stats_copy(pid, stats) != 0) {
+        report_error(tag, "syscall_stats: no table for pid %d, exit", pid);
+        free(stats);
+        return -1;
+    }
+
+    memcpy(buf, stats, n * sizeof(syscall_stat_t));
+    free(stats);
+
+    report_progress(tag, "copied %d entries, exit", n);
+    return n;
+}
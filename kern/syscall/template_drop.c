@@ -0,0 +1,28 @@
+/** @file kern/template_drop.c
+ *
+ *  @brief template_drop syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <template.h>
+
+static char *tag = "template_drop";
+
+int template_drop_handler(int id) {
+    report_progress(tag, "entry");
+
+    pcb_t *pcb = running_ktcb->tcb->pcb;
+
+    if (template_remove(id, pcb->pid) != 0) {
+        report_error(tag, "can't drop template %d, exit", id);
+        return -1;
+    }
+
+    report_progress(tag, "exit");
+    return 0;
+}
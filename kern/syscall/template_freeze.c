@@ -0,0 +1,124 @@
+/** @file kern/template_freeze.c
+ *
+ *  @brief template_freeze syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+
+#include <common_include.h>
+#include <malloc.h>
+#include <template.h>
+
+static char *tag = "template_freeze";
+
+void template_freeze_handler() {
+    report_progress(tag, "entry");
+
+    /* get the running process */
+    ktcb_t *ktcb = running_ktcb;
+    tcb_t *tcb = ktcb->tcb;
+    pcb_t *pcb = tcb->pcb;
+    unsigned long ebp = get_ebp();
+
+    /* check that the process only has one thread */
+    mutex_lock(&(pcb->tcb_ht->mp));
+    if (ht_size(pcb->tcb_ht) > 1) {
+        mutex_unlock(&(pcb->tcb_ht->mp));
+        report_error(tag, "can't freeze process with >1 threads, exit");
+
+        *(int *)(ebp + 8) = -1;
+        return;
+    }
+    mutex_unlock(&(pcb->tcb_ht->mp));
+
+    /* allocate structures */
+    template_t *t = calloc(1, sizeof(template_t));
+    if (t == NULL) {
+        report_error(tag, "can't alloc template, exit");
+
+        *(int *)(ebp + 8) = -1;
+        return;
+    }
+
+    if ((t->regs = reg_copy(tcb->regs)) == NULL) {
+        report_error(tag, "can't copy reg, exit");
+
+        free(t);
+        *(int *)(ebp + 8) = -1;
+        return;
+    }
+
+    /* save the kernel stack from here up to the trap frame, instances
+     * resume from it like a forked child does
+     */
+    t->kstack_len = ktcb->regs->esp0 - ebp + 4;
+    if ((t->kstack = malloc(t->kstack_len)) == NULL) {
+        report_error(tag, "can't alloc kernel stack copy, exit");
+
+        free(t->regs);
+        free(t);
+        *(int *)(ebp + 8) = -1;
+        return;
+    }
+    memcpy(t->kstack, (void *)(ktcb->regs->esp0 - t->kstack_len),
+           t->kstack_len);
+
+    /* allocate template pgd */
+    unsigned long pgd = pcb->pgd;
+    if ((t->pgd = pgd_alloc()) == NULL) {
+        report_error(tag, "can't alloc template pgd, exit");
+
+        free(t->kstack);
+        free(t->regs);
+        free(t);
+        *(int *)(ebp + 8) = -1;
+        return;
+    }
+
+    /* instances live under the same frame limit */
+    PGD_ACCT(t->pgd)->max_frames = PGD_ACCT(pgd)->max_frames;
+
+    /* COW pages */
+    if (vm_ref_copy((void *)pgd, t->pgd, 1) != 0) {
+        report_error(tag, "can't copy pgd, exit");
+
+        vm_ref_copy_rollback(t->pgd);
+        pgd_free(t->pgd);
+        free(t->kstack);
+        free(t->regs);
+        free(t);
+        *(int *)(ebp + 8) = -1;
+        return;
+    }
+
+    t->has_stack = (stack_region_save(pcb, tcb->tid, &(t->stack)) == 0);
+
+    t->owner = pcb->pid;
+
+    t->txt_base = pcb->txt_base;
+    t->txt_len = pcb->txt_len;
+    t->rodat_base = pcb->rodat_base;
+    t->rodat_len = pcb->rodat_len;
+
+    int id;
+    if ((id = template_add(t)) < 0) {
+        report_error(tag, "too many templates, exit");
+
+        pgd_cleanup(t->pgd);
+        pgd_free(t->pgd);
+        free(t->kstack);
+        free(t->regs);
+        free(t);
+        *(int *)(ebp + 8) = -1;
+        return;
+    }
+
+    report_progress(tag, "process %d frozen as template %d, exit",
+                    pcb->pid, id);
+
+    /* the freezer gets the id, instances get 0 */
+    *(int *)(ebp + 8) = id;
+}
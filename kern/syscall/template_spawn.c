@@ -0,0 +1,132 @@
+/** @file kern/template_spawn.c
+ *
+ *  @brief template_spawn syscall implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_handler.h>
+
+#include <common_include.h>
+#include <malloc.h>
+#include <template.h>
+
+static char *tag = "template_spawn";
+
+int template_spawn_handler(int id) {
+    report_progress(tag, "entry");
+
+    /* get the running process */
+    ktcb_t *ktcb = running_ktcb;
+    pcb_t *pcb = ktcb->tcb->pcb;
+    unsigned long pgd = pcb->pgd;
+
+    template_t *t = template_get(id);
+    if (t == NULL) {
+        report_error(tag, "no template %d, exit", id);
+        return -1;
+    }
+
+    /* allocate structures */
+    reg_t *new_regs = reg_copy(t->regs);
+    if (new_regs == NULL) {
+        report_error(tag, "can't copy new reg, exit");
+
+        template_put(t);
+        return -1;
+    }
+
+    /* allocate new pgd */
+    unsigned long new_pgd = (unsigned long)pgd_alloc();
+    if (new_pgd == 0) {
+        report_error(tag, "can't alloc new pgd, exit");
+
+        free(new_regs);
+        template_put(t);
+        return -1;
+    }
+
+    PGD_ACCT(new_pgd)->max_frames = PGD_ACCT(t->pgd)->max_frames;
+
+    /* COW pages. The template pages are read only already, so the
+     * template pgd is left alone, but vm_ref_copy loads it into cr3
+     */
+    int ret = vm_ref_copy(t->pgd, (void *)new_pgd, 0);
+    set_cr3(pgd);
+
+    if (ret != 0) {
+        report_error(tag, "can't copy template pgd, exit");
+
+        vm_ref_copy_rollback((void *)new_pgd);
+        pgd_free((void *)new_pgd);
+        free(new_regs);
+        template_put(t);
+        return -1;
+    }
+
+    /* allocate new ktcb */
+    ktcb_t *new_ktcb;
+    if ((new_ktcb = kthr_alloc()) == NULL) {
+        report_error(tag, "can't alloc new ktcb, exit");
+
+        pgd_cleanup((void *)new_pgd);
+        pgd_free((void *)new_pgd);
+        free(new_regs);
+        template_put(t);
+        return -1;
+    }
+
+    /* allocate new pcb */
+    pcb_t *new_pcb = pcb_create(new_pgd, new_regs, pcb, new_ktcb,
+                                t->txt_base, t->txt_len, t->rodat_base,
+                                t->rodat_len);
+    if (new_pcb == NULL) {
+        report_error(tag, "can't create new pcb, exit");
+
+        kthr_free(new_ktcb);
+        pgd_cleanup((void *)new_pgd);
+        pgd_free((void *)new_pgd);
+        free(new_regs);
+        template_put(t);
+        return -1;
+    }
+
+    if (t->has_stack &&
+        stack_region_restore(new_pcb, new_pcb->pid, &(t->stack)) != 0)
+        report_error(tag, "instance stack will not grow on its own");
+
+    /* set up new ktcb stack from the frozen one */
+    memcpy((void *)(new_ktcb->regs->esp0 - t->kstack_len), t->kstack,
+           t->kstack_len);
+
+    /* set up new ktcb registers */
+    new_ktcb->regs->ebp = new_ktcb->regs->esp0 - t->kstack_len + 4;
+
+    /* the instance returns 0 from template_freeze */
+    *(int *)(new_ktcb->regs->ebp + 8) = 0;
+
+    template_put(t);
+
+    /* make child relation and schedule child */
+    report_progress(tag, "make new process %d child of process %d",
+                    new_pcb->pid,  pcb->pid);
+
+    mutex_lock(&(pcb->children->mp));
+    ht_insert(pcb->children, new_pcb->pid, (void *)new_pcb);
+    mutex_unlock(&(pcb->children->mp));
+
+    int pid = new_pcb->pid;
+
+    int if_was_set = if_disable();
+
+    if (sched_running_to_runnable(ktcb) != 0)
+        report_error(tag, "cannot add to runnable queue");
+
+    cs_save_and_switch(ktcb, new_ktcb);
+
+    if_recover(if_was_set);
+
+    report_progress(tag, "spawned process %d, exit", pid);
+    return pid;
+}
@@ -9,6 +9,9 @@
 #include <syscall_handler.h>
 
 #include <common_include.h>
+#include <reaper.h>
+#include <template.h>
+#include <stack_region.h>
 
 static char *tag = "vanish";
 
@@ -19,18 +22,28 @@ void vanish_handler() {
     pcb_t *pcb = tcb->pcb;
     void *pgd = (void *)pcb->pgd;
 
+    /* the stack of the thread is free for the next one */
+    stack_region_remove(pcb, tcb->tid);
+
     int process_exited;
     
     /* clean up memory if all threads exited */
     if ((process_exited = 
             (pcb->exited_thread_count == (ht_size(pcb->tcb_ht) - 1)))) {
 
+        /* the terminal it drew on directly goes back to the console */
+        vt_release(pcb->pid);
+
         /* use kern pgd since going to free its own pgd */
         pcb->pgd = (unsigned long)kern_pgd;
         set_cr3((unsigned long)kern_pgd);
 
-        report_progress(tag, "going to cleanup pgd");
-        pgd_process_cleanup(pgd);
+        /* the reaper frees the memory after the parent is signaled */
+        report_progress(tag, "going to queue pgd for teardown");
+        reaper_enqueue(pgd);
+
+        /* nobody else may drop the templates it froze */
+        template_remove_owned(pcb->pid);
    
         mutex_lock(&(pcb->children->mp));
         ht_traverse_all(pcb->children, announce_parent_death);
@@ -52,6 +65,7 @@ void vanish_handler() {
             report_progress(tag, "pcb %p signaling parent %p, exit", 
                             pcb, pcb->parent);
             report_progress(tag, "signal parent %d", pcb->parent->pid);
+            waitq_wake(&(pcb->parent->child_waitq));
             cond_signal_terminate(&(pcb->parent->wait_cond));
         }
    }
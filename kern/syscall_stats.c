@@ -0,0 +1,111 @@
+/** @file kern/syscall_stats.c
+ *
+ *  @brief per syscall statistics implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall_stats.h>
+#include <common_include.h>
+
+#if SYSCALL_STATS_ENABLED
+
+/* the syscalls of all processes */
+static syscall_stat_t global_stats[SYSCALL_STAT_NSYS];
+
+/** @brief check if a syscall returns a status, the others leave whatever
+ *         is in eax
+ *
+ *  @param nr the SYS_ number
+ *  @return 1 if it does, 0 if not
+ */
+static int syscall_has_status(int nr)
+{
+    switch (nr) {
+    case SYS_GETCHAR:
+    case SYS_MISBEHAVE:
+    case SYS_HALT:
+    case SYS_TASK_VANISH:
+    case SYS_SET_STATUS:
+    case SYS_VANISH:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+/** @brief add a call to a statistics entry
+ *
+ *  @param stat the entry
+ *  @param err if the call failed
+ *  @param cycles how long it took
+ *  @return Void
+ */
+static void syscall_stat_add(syscall_stat_t *stat, int err,
+                             unsigned long long cycles)
+{
+    int bucket = 0;
+
+    if (cycles > 1)
+        bucket = 63 - __builtin_clzll(cycles);
+    if (bucket >= SYSCALL_STAT_BUCKETS)
+        bucket = SYSCALL_STAT_BUCKETS - 1;
+
+    stat->calls++;
+    stat->errors += err;
+    stat->total_cycles += cycles;
+    if (cycles > stat->max_cycles)
+        stat->max_cycles = cycles;
+    stat->hist[bucket]++;
+}
+
+int syscall_stats_call(int (*handler)(void *), int nr, void *arg)
+{
+    unsigned long long start, cycles;
+    int ret, err, if_was_set;
+
+    start = get_tsc();
+    ret = handler(arg);
+    cycles = get_tsc() - start;
+
+    err = (ret < 0 && syscall_has_status(nr));
+
+    /* threads of the same process may preempt each other in here */
+    if_was_set = if_disable();
+    syscall_stat_add(&(running_ktcb->tcb->pcb->sys_stats[nr]), err, cycles);
+    syscall_stat_add(&(global_stats[nr]), err, cycles);
+    if_recover(if_was_set);
+
+    return ret;
+}
+
+int syscall_stats_copy(int pid, syscall_stat_t *stats)
+{
+    pcb_t *pcb;
+    int if_was_set = if_disable();
+
+    if (pid == 0) {
+        memcpy(stats, global_stats, sizeof(global_stats));
+    }
+    else {
+        /* looked up and copied before it can be reaped */
+        if ((pcb = sched_find_pcb(pid)) == NULL) {
+            if_recover(if_was_set);
+            return -1;
+        }
+        memcpy(stats, pcb->sys_stats, sizeof(pcb->sys_stats));
+    }
+
+    if_recover(if_was_set);
+    return 0;
+}
+
+#else
+
+int syscall_stats_copy(int pid, syscall_stat_t *stats)
+{
+    return -1;
+}
+
+#endif /* SYSCALL_STATS_ENABLED */
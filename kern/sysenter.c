@@ -0,0 +1,39 @@
+/** @file kern/sysenter.c
+ *
+ *  @brief the SYSENTER/SYSEXIT syscall entry setup
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <sysenter.h>
+#include <common_wrapper.h>
+#include <asm.h>
+#include <reporter.h>
+#include <x86/seg.h>
+
+static char *tag = "sysenter";
+
+int sysenter_init(void)
+{
+    /* SYSENTER takes ss from cs + 8, SYSEXIT takes cs and ss from the
+     * kernel cs + 16 and + 24 (with RPL 3)
+     */
+    if (SEGSEL_KERNEL_DS != SEGSEL_KERNEL_CS + 8 ||
+        SEGSEL_USER_CS != (SEGSEL_KERNEL_CS + 16) + 3 ||
+        SEGSEL_USER_DS != (SEGSEL_KERNEL_CS + 24) + 3) {
+        report_error(tag, "segment layout does not allow SYSEXIT");
+        return -1;
+    }
+
+    set_msr(MSR_SYSENTER_CS, SEGSEL_KERNEL_CS);
+    set_msr(MSR_SYSENTER_EIP, (unsigned long)sysenter_wrapper);
+    set_msr(MSR_SYSENTER_ESP, 0);
+
+    return 0;
+}
+
+void sysenter_set_esp0(unsigned long esp0)
+{
+    set_msr(MSR_SYSENTER_ESP, esp0);
+}
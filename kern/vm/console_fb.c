@@ -0,0 +1,42 @@
+/** @file kern/vm/console_fb.c
+ *
+ *  @brief the text framebuffer a process can map
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <console_fb.h>
+#include <console.h>
+#include <vm.h>
+#include <pgtable.h>
+#include <reporter.h>
+#include <x86/cr.h>
+
+static char *tag = "console_fb";
+
+/* the page table of each terminal, in the direct mapped kernel image */
+static void *fb_pt[NVTERMS][PAGE_SIZE / 4] __attribute__((aligned(PAGE_SIZE)));
+
+void console_fb_map(void *pgd, int idx, void *cells)
+{
+    /* readable and writable from user space */
+    fb_pt[idx][GET_PT_INDEX(CONSOLE_FB_ADDR)] =
+        (void *)((unsigned long)cells | PG_PRESENT | PG_WRITABLE | PG_USER);
+
+    *(void **)(pgd + 4 * CONSOLE_FB_PGD_INDEX) =
+        (void *)((unsigned long)fb_pt[idx] | PG_PRESENT | PG_WRITABLE |
+                 PG_USER);
+
+    report_progress(tag, "console_fb_map: terminal %d mapped at 0x%x in %p",
+                    idx, CONSOLE_FB_ADDR, pgd);
+}
+
+void console_fb_unmap(void *pgd)
+{
+    *(void **)(pgd + 4 * CONSOLE_FB_PGD_INDEX) = NULL;
+
+    /* the old translation may still be cached */
+    if (GET_ADDRESS(get_cr3()) == pgd)
+        set_cr3(get_cr3());
+}
@@ -0,0 +1,126 @@
+/** @file kern/vm/lz.c
+ *
+ *  @brief a small LZ77 (LZRW1 style) compressor for page sized buffers
+ *
+ *  The match finder remembers, for a hash of every 3 bytes, the last
+ *  position they were seen at. That is a single probe per byte, so pages
+ *  compress in linear time.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <lz.h>
+#include <string.h>
+
+/* hash the 3 bytes starting at p */
+#define LZ_HASH(p) ((((p)[0] << 8) ^ ((p)[1] << 4) ^ (p)[2]) * 40543 >> 4 \
+                    & (LZ_TABLE_SIZE - 1))
+
+int lz_compress(const unsigned char *src, int src_len,
+                unsigned char *dst, int dst_cap, unsigned short *table)
+{
+    int ip = 0;
+    int op = 0;
+    int ctrl_pos;
+    int item;
+    unsigned int ctrl;
+
+    /* positions are stored plus one, so 0 means no candidate */
+    memset(table, 0, LZ_TABLE_SIZE * sizeof(unsigned short));
+
+    while (ip < src_len) {
+        /* make sure a whole group fits before starting it */
+        if (op + 2 + 2 * LZ_GROUP > dst_cap)
+            return -1;
+
+        ctrl_pos = op;
+        op += 2;
+        ctrl = 0;
+
+        for (item = 0; item < LZ_GROUP && ip < src_len; item++) {
+            int cand = -1;
+            int match = 0;
+
+            if (ip + LZ_MIN_MATCH <= src_len) {
+                int h = LZ_HASH(src + ip);
+                int max = src_len - ip;
+
+                if (max > LZ_MAX_MATCH)
+                    max = LZ_MAX_MATCH;
+
+                cand = (int)table[h] - 1;
+                table[h] = ip + 1;
+
+                if (cand >= 0 && ip - cand <= LZ_MAX_OFFSET) {
+                    while (match < max && src[cand + match] == src[ip + match])
+                        match++;
+                }
+            }
+
+            if (match >= LZ_MIN_MATCH) {
+                int offset = ip - cand;
+
+                dst[op++] = (offset >> 4) & 0xff;
+                dst[op++] = ((offset & 0xf) << 4) | (match - LZ_MIN_MATCH);
+                ctrl |= 1 << item;
+                ip += match;
+            }
+            else {
+                dst[op++] = src[ip++];
+            }
+        }
+
+        dst[ctrl_pos] = ctrl & 0xff;
+        dst[ctrl_pos + 1] = (ctrl >> 8) & 0xff;
+    }
+
+    return op;
+}
+
+int lz_decompress(const unsigned char *src, int src_len,
+                  unsigned char *dst, int dst_cap)
+{
+    int ip = 0;
+    int op = 0;
+    int item;
+    unsigned int ctrl;
+
+    while (ip < src_len) {
+        if (ip + 2 > src_len)
+            return -1;
+
+        ctrl = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+
+        for (item = 0; item < LZ_GROUP && ip < src_len; item++) {
+            if (ctrl & (1 << item)) {
+                int offset, len;
+
+                if (ip + 2 > src_len)
+                    return -1;
+
+                offset = (src[ip] << 4) | (src[ip + 1] >> 4);
+                len = (src[ip + 1] & 0xf) + LZ_MIN_MATCH;
+                ip += 2;
+
+                if (offset == 0 || offset > op || op + len > dst_cap)
+                    return -1;
+
+                /* byte by byte, the copy may overlap itself */
+                while (len-- > 0) {
+                    dst[op] = dst[op - offset];
+                    op++;
+                }
+            }
+            else {
+                if (op >= dst_cap)
+                    return -1;
+
+                dst[op++] = src[ip++];
+            }
+        }
+    }
+
+    return op;
+}
@@ -9,6 +9,9 @@
 #include <pgtable.h>
 #include <cr.h>
 #include <reporter.h>
+#include <zswap.h>
+#include <vdso.h>
+#include <console_fb.h>
 
 static char *tag = "pgtable";
 
@@ -16,14 +19,15 @@ void *pgd_alloc(void)
 {
     report_progress(tag, "pgd_alloc: entry");
 
-    void *free_frm = smemalign(PAGE_SIZE, PAGE_SIZE);
+    /* the accounting block rides right after the directory */
+    void *free_frm = smemalign(PAGE_SIZE, PGD_ALLOC_SIZE);
     
     if (free_frm == NULL) {
         report_error(tag, "pgd_alloc: smemalign failed");
         return NULL;
     }
     
-    memset(free_frm, 0, PAGE_SIZE);
+    memset(free_frm, 0, PGD_ALLOC_SIZE);
     
     report_progress(tag, "pgd_alloc: allocated %p", free_frm);
     return free_frm;
@@ -41,6 +45,10 @@ void pgd_free(void* pgd)
     unsigned long pt_flags;
 
     for (i = 4; i < PAGE_SIZE/4; i++) {
+        /* the vdso and the framebuffer page tables are shared */
+        if (i == VDSO_PGD_INDEX || i == CONSOLE_FB_PGD_INDEX)
+            continue;
+
         pgd_addr = pgd + 4 * i;
         pgd_entry = *(void **)pgd_addr;
    
@@ -53,7 +61,7 @@ void pgd_free(void* pgd)
         sfree(pt, PAGE_SIZE);
     }
     
-    sfree(pgd, PAGE_SIZE);
+    sfree(pgd, PGD_ALLOC_SIZE);
     return;
 }
 
@@ -89,6 +97,11 @@ void *check_and_alloc_pt(void *pgd, int pgd_index,
         memset(pt, 0, PAGE_SIZE);
 
         *(void **)pgd_addr = (void *)((unsigned long)pt | pt_flags);
+
+        /* the first 4 entries are the kernel direct map */
+        if (pgd_index >= 4)
+            PGD_ACCT_ADD(pgd, pt_pages, 1);
+
         return pt;
     }
     else {
@@ -155,8 +168,9 @@ void check_and_delete_pt(void *pgd, void *base, int len) {
             frm = GET_ADDRESS(pt_entry);
             frm_flags = GET_FLAGS(pt_entry);
 
-            /* found content */
-            if (frm != NULL && IS_PRESENT(frm_flags)) {
+            /* found content, swapped out pages count as well */
+            if ((frm != NULL && IS_PRESENT(frm_flags)) || 
+                IS_SWAPPED(pt_entry)) {
                 has_content = 1;
                 break;
             }
@@ -167,6 +181,7 @@ void check_and_delete_pt(void *pgd, void *base, int len) {
             report_progress(tag, "check_and_delete_pt: deleting pt %p", pt);
             *(void **)pgd_addr = NULL;
             sfree(pt, PAGE_SIZE);
+            PGD_ACCT_ADD(pgd, pt_pages, -1);
         }
         else {
             report_progress(tag, "check_and_delete_pt: pt %p has content", pt);
@@ -205,6 +220,52 @@ int pgd_direct_map(void *pgd, void *linear_addr, unsigned long flags)
 }
 
 
+int pgd_acct_may_grow(void *pgd, int frames)
+{
+    vm_acct_t *acct = PGD_ACCT(pgd);
+
+    if (acct->max_frames == 0)
+        return 1;
+
+    return acct->resident - acct->shared + frames <= acct->max_frames;
+}
+
+int pgd_unmap_page(void *pgd, void *linear_addr)
+{
+    void *frm;
+    int refs;
+
+    /* a swapped out page only holds a slot in the pool */
+    if (zswap_drop(pgd, linear_addr))
+        return 0;
+
+    if ((frm = pt_entry_delete(pgd, linear_addr, 0)) == NULL) {
+        report_error(tag, "pgd_unmap_page: nothing mapped at %p", 
+                     linear_addr);
+        return -1;
+    }
+
+    mutex_lock(&frm_ref_mp);
+    refs = get_frame_refs(frm);
+    set_frame_refs(frm, (refs == 1) ? -1 : refs - 1);
+    mutex_unlock(&frm_ref_mp);
+
+    if (refs < 1)
+        report_error(tag, "pgd_unmap_page: ref count less than 1");
+
+    /* the frame may still be shared copy-on-write with another process */
+    if (refs == 1) {
+        mutex_lock(&frm_mp);
+        frame_free(frm);
+        mutex_unlock(&frm_mp);
+    }
+    else {
+        frame_clear_owner(frm, pgd);
+    }
+
+    return 0;
+}
+
 int pgd_alloc_pages(void *pgd, void *start_linear_addr, int size, 
                     unsigned long pt_flags, unsigned long frm_flags)
 {
@@ -216,6 +277,12 @@ int pgd_alloc_pages(void *pgd, void *start_linear_addr, int size,
             
             report_error(tag, "failed to add one page from %p", 
                         aligned_linear_addr);
+
+            /* give back what we got so far */
+            while (aligned_linear_addr > GET_ADDRESS(start_linear_addr)) {
+                aligned_linear_addr -= PAGE_SIZE;
+                pgd_unmap_page(pgd, aligned_linear_addr);
+            }
             return -1;
         }
 
@@ -265,8 +332,16 @@ void *pt_entry_delete(void *pgd, void *linear_addr, int delete_pt)
         *(void **)pgd_addr = NULL;
     }
 
+    if (IS_USER(frm_flags)) {
+        PGD_ACCT_ADD(pgd, resident, -1);
+        if (frm_flags & PG_COW)
+            PGD_ACCT_ADD(pgd, shared, -1);
+    }
+
     if (delete_pt) {
         sfree(pt, PAGE_SIZE);
+        if (pgd_index >= 4)
+            PGD_ACCT_ADD(pgd, pt_pages, -1);
     }
     
     return frm;
@@ -295,21 +370,40 @@ int pgd_insert(void *pgd, void *linear_addr, unsigned long pt_flags,
 
     /* physical frame did exist */
     if (*(void **)pt_addr != NULL) {
-        *(void **)pt_addr = ADD_FLAGS(*(void **)pt_addr, frm_flags);
+        void *old_entry = *(void **)pt_addr;
+
+        if (IS_SWAPPED(old_entry)) {
+            report_error(tag, "pgd_insert: page at %p is swapped out", 
+                         linear_addr);
+            return -1;
+        }
+
+        *(void **)pt_addr = ADD_FLAGS(old_entry, frm_flags);
+
+        /* the page may have become, or stopped being, copy-on-write */
+        if (IS_USER(frm_flags) && IS_PRESENT(frm_flags) &&
+            (GET_FLAGS(old_entry) & PG_COW) != (frm_flags & PG_COW))
+            PGD_ACCT_ADD(pgd, shared, (frm_flags & PG_COW) ? 1 : -1);
+
         report_warning(tag, "pgd_insert: frame exist.");
         return 0;
     }
 
     /* physical frame didn't exist */
     if (phy_frame == NULL) {
-        mutex_lock(&(frm_mp));
-        free_frm = frame_alloc();
-        mutex_unlock(&(frm_mp));
+        if (IS_USER(frm_flags) && !pgd_acct_may_grow(pgd, 1)) {
+            report_warning(tag, "pgd_insert: over the frame limit of %p", 
+                           pgd);
+            return -1;
+        }
 
-        if (free_frm == NULL) {
+        if ((free_frm = frame_alloc_reclaim()) == NULL) {
             report_error(tag, "no physical pages");
             return -1;
         }
+
+        /* remember who maps the new frame for the swap clock */
+        frame_set_owner(free_frm, pgd, linear_addr);
     }
     else {
         /* given a specific physical frame that the linear address */
@@ -319,9 +413,32 @@ int pgd_insert(void *pgd, void *linear_addr, unsigned long pt_flags,
 
     *(void **)pt_addr = (void *)((unsigned long)free_frm | frm_flags);
 
+    if (IS_USER(frm_flags) && IS_PRESENT(frm_flags)) {
+        PGD_ACCT_ADD(pgd, resident, 1);
+        if (frm_flags & PG_COW)
+            PGD_ACCT_ADD(pgd, shared, 1);
+    }
+
     return 0;
 }
 
+void **pgd_get_pte(void *pgd, void *linear_addr)
+{
+    if (pgd == NULL) {
+        report_error(tag, "pgd_get_pte: got NULL pgd");
+        return NULL;
+    }
+
+    void *pgd_entry = *(void **)(pgd + 4 * GET_PGD_INDEX(linear_addr));
+    void *pt = GET_ADDRESS(pgd_entry);
+
+    if (pt == NULL || !IS_PRESENT(GET_FLAGS(pgd_entry))) {
+        return NULL;
+    }
+
+    return (void **)(pt + 4 * GET_PT_INDEX(linear_addr));
+}
+
 void *pgd_get_frm(void *pgd, void *linear_addr) 
 {
     if (pgd == NULL) {
@@ -441,6 +558,10 @@ void pgd_cleanup(void *pgd)
     int refs;
 
     for (i = 4; i < PAGE_SIZE/4; i++) {
+        /* the vdso and the framebuffer page tables are shared */
+        if (i == VDSO_PGD_INDEX || i == CONSOLE_FB_PGD_INDEX)
+            continue;
+
         pgd_addr = pgd + 4 * i;
         pgd_entry = *(void **)pgd_addr;
         
@@ -452,6 +573,12 @@ void pgd_cleanup(void *pgd)
             pt_addr = pt + 4 * j;
             pt_entry = *(void **)pt_addr;
 
+            /* drop the compressed copy of a swapped out page */
+            if (IS_SWAPPED(pt_entry)) {
+                zswap_put(SWAP_SLOT(pt_entry));
+                continue;
+            }
+
             frm = GET_ADDRESS(pt_entry);
             if (frm == NULL)
                 continue;
@@ -469,6 +596,9 @@ void pgd_cleanup(void *pgd)
                 frame_free(frm);
                 mutex_unlock(&frm_mp);
             }
+            else {
+                frame_clear_owner(frm, pgd);
+            }
 
         }
 
@@ -571,14 +701,24 @@ void pgd_process_cleanup(void *pgd) {
     }
 
     int pgd_index, pt_index;
-    void *pgd_addr, *pgd_entry, *pt_addr, *pt_entry, *pt, *frm;
+    void *pgd_entry, *pt_entry, *pt, *frm;
     unsigned long pt_flags, frm_flags;
 
-    int refs_count;
+    void *batch[FRAME_RELEASE_BATCH];
+    int count = 0;
+    int freed = 0;
+
+    /* keep the swap clock away, and wait out a sweep already looking */
+    PGD_ACCT(pgd)->dying = 1;
+    zswap_barrier();
 
     for (pgd_index = 4; pgd_index < PAGE_SIZE/4; pgd_index++) {
-        pgd_addr = pgd + 4 * pgd_index;
-        pgd_entry = *(void **)pgd_addr;
+        /* the vdso and the framebuffer page tables are shared */
+        if (pgd_index == VDSO_PGD_INDEX ||
+            pgd_index == CONSOLE_FB_PGD_INDEX)
+            continue;
+
+        pgd_entry = *(void **)(pgd + 4 * pgd_index);
 
         pt = GET_ADDRESS(pgd_entry);
         pt_flags = GET_FLAGS(pgd_entry);
@@ -589,9 +729,13 @@ void pgd_process_cleanup(void *pgd) {
         }
 
         for (pt_index = 0; pt_index < PAGE_SIZE/4; pt_index++) {
+            pt_entry = *(void **)(pt + 4 * pt_index);
 
-            pt_addr = pt + 4 * pt_index;
-            pt_entry = *(void **)pt_addr;
+            /* drop the compressed copy of a swapped out page */
+            if (IS_SWAPPED(pt_entry)) {
+                zswap_put(SWAP_SLOT(pt_entry));
+                continue;
+            }
 
             frm = GET_ADDRESS(pt_entry);
             frm_flags = GET_FLAGS(pt_entry);
@@ -601,33 +745,25 @@ void pgd_process_cleanup(void *pgd) {
                 continue;
             }
 
-            mutex_lock(&frm_ref_mp);
-            refs_count = get_frame_refs(frm);
-            set_frame_refs(frm, (refs_count == 1) ? -1 : refs_count - 1);
-            mutex_unlock(&frm_ref_mp);
-            
-            if (refs_count < 1) {
-                report_error(tag, "pgd_process_cleanup: refs_count < 1");
-                return;
-            }
-
-            if (refs_count == 1) {
-                report_progress(tag, 
-            "pgd_process_cleanup: going to free frame %p at linear_addr %p", 
-                                frm, GET_LINEAR_ADDR(pgd_index, pt_index));
-                mutex_lock(&(frm_mp));
-                frame_free(frm);
-                mutex_unlock(&(frm_mp));
+            batch[count++] = frm;
+            if (count == FRAME_RELEASE_BATCH) {
+                freed += frame_release_batch(batch, count, pgd);
+                count = 0;
             }
         }
-
-        /* free the pt */
-        report_progress(tag, "pgd_process_cleanup: going to free pt %p", pt);
-        sfree(pt, PAGE_SIZE);
     }
 
-    /* free the pgd */
-    report_progress(tag, "pgd_process_cleanup: going to free pgd %p", pgd);
-    sfree(pgd, PAGE_SIZE);
+    if (count > 0)
+        freed += frame_release_batch(batch, count, pgd);
+
+    report_progress(tag, "pgd_process_cleanup: freed %d frames of pgd %p", 
+                    freed, pgd);
+
+    /* no frame names the pgd as its owner now, let a sweep that read an
+     * owner before we cleared it finish before the page tables go away
+     */
+    zswap_barrier();
 
+    /* free the pts and the pgd */
+    pgd_free(pgd);
 }
@@ -0,0 +1,141 @@
+/** @file kern/vm/reaper.c
+ *
+ *  @brief background teardown of the address spaces of exited processes
+ *
+ *  The queue is linked through the accounting block behind each pgd, so
+ *  queueing never allocates on the exit path.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <reaper.h>
+#include <pgtable.h>
+#include <sched.h>
+#include <mutex.h>
+#include <cond.h>
+#include <x86/asm.h>
+#include <reporter.h>
+
+static char *tag = "reaper";
+
+/* the pgds waiting for teardown */
+static void *reap_head;
+static void *reap_tail;
+
+/* protects the queue */
+static mutex_t reap_mp;
+
+/* the reaper thread waits here for work */
+static cond_t reap_cond;
+
+static int reaper_ready = 0;
+
+/** @brief take the first pgd off the queue
+ *
+ *  @return the pgd, NULL if the queue is empty
+ */
+static void *reaper_dequeue(void)
+{
+    void *pgd;
+
+    mutex_lock(&reap_mp);
+
+    if ((pgd = reap_head) != NULL) {
+        reap_head = PGD_ACCT(pgd)->reap_next;
+        if (reap_head == NULL)
+            reap_tail = NULL;
+    }
+
+    mutex_unlock(&reap_mp);
+
+    return pgd;
+}
+
+/** @brief the body of the reaper thread
+ *
+ *  @return never returns
+ */
+static void reaper_run(void)
+{
+    /* context switches run with interrupts off, a fresh thread has no
+     * if_recover to turn them back on
+     */
+    enable_interrupts();
+
+    while (1) {
+        mutex_lock(&reap_mp);
+        while (reap_head == NULL)
+            cond_wait(&reap_cond, &reap_mp);
+        mutex_unlock(&reap_mp);
+
+        reaper_drain();
+    }
+}
+
+int reaper_init(void)
+{
+    if (mutex_init(&reap_mp) != 0) {
+        report_error(tag, "reaper_init: can't init reap_mp");
+        return -1;
+    }
+
+    if (cond_init(&reap_cond) != 0) {
+        report_error(tag, "reaper_init: can't init reap_cond");
+        return -1;
+    }
+
+    reap_head = NULL;
+    reap_tail = NULL;
+
+    if (sched_spawn_kthread(reaper_run) == NULL) {
+        report_error(tag, "reaper_init: can't start the reaper thread");
+        return -1;
+    }
+
+    reaper_ready = 1;
+    return 0;
+}
+
+void reaper_enqueue(void *pgd)
+{
+    if (!reaper_ready) {
+        pgd_process_cleanup(pgd);
+        return;
+    }
+
+    PGD_ACCT(pgd)->reap_next = NULL;
+
+    mutex_lock(&reap_mp);
+
+    if (reap_tail == NULL)
+        reap_head = pgd;
+    else
+        PGD_ACCT(reap_tail)->reap_next = pgd;
+    reap_tail = pgd;
+
+    /* only make the reaper runnable, the exiting thread still has to
+     * signal its parent
+     */
+    cond_broadcast(&reap_cond);
+
+    mutex_unlock(&reap_mp);
+
+    report_progress(tag, "reaper_enqueue: queued pgd %p", pgd);
+}
+
+int reaper_drain(void)
+{
+    void *pgd;
+    int count = 0;
+
+    if (!reaper_ready)
+        return 0;
+
+    while ((pgd = reaper_dequeue()) != NULL) {
+        pgd_process_cleanup(pgd);
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,286 @@
+/** @file kern/vm/stack_region.c
+ *
+ *  @brief grow-down user stack regions implementation
+ *
+ *  The regions of a process sit in a short list on its pcb, one per thread
+ *  that registered its stack, guarded by pcb->stack_mp.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <stack_region.h>
+#include <common_include.h>
+#include <zswap.h>
+
+static char *tag = "stack_region";
+
+/** @brief find the stack region of a thread, pcb->stack_mp has to be held
+ *
+ *  @param pcb the process
+ *  @param tid the thread
+ *  @return the region, NULL if the thread has none
+ */
+static stack_region_t *stack_region_find(pcb_t *pcb, int tid)
+{
+    stack_region_t *r;
+
+    for (r = pcb->stack_regions; r != NULL; r = r->next) {
+        if (r->tid == tid)
+            return r;
+    }
+
+    return NULL;
+}
+
+/** @brief check if a range collides with a region other than skip,
+ *         pcb->stack_mp has to be held
+ *
+ *  @param pcb the process
+ *  @param skip the region to leave out, may be NULL
+ *  @param base the base of the range
+ *  @param end the end of the range, exclusive
+ *  @return 1 if it does, 0 if not
+ */
+static int stack_region_collides(pcb_t *pcb, stack_region_t *skip,
+                                 unsigned long base, unsigned long end)
+{
+    stack_region_t *r;
+
+    for (r = pcb->stack_regions; r != NULL; r = r->next) {
+        if (r != skip && base < r->hi && end > r->limit - r->guard)
+            return 1;
+    }
+
+    return 0;
+}
+
+int stack_region_set(pcb_t *pcb, int tid, unsigned long hi, unsigned long lo,
+                     int max_len, int guard_len)
+{
+    void *pgd = (void *)pcb->pgd;
+    stack_region_t *r;
+
+    mutex_lock(&(pcb->stack_mp));
+    r = stack_region_find(pcb, tid);
+
+    /* unregister */
+    if (max_len == 0) {
+        mutex_unlock(&(pcb->stack_mp));
+
+        if (r == NULL) {
+            report_error(tag, "thread %d has no stack region", tid);
+            return -1;
+        }
+
+        stack_region_remove(pcb, tid);
+        return 0;
+    }
+
+    if ((hi & (PAGE_SIZE - 1)) != 0 || (lo & (PAGE_SIZE - 1)) != 0 ||
+        max_len < 0 || (max_len % PAGE_SIZE) != 0 ||
+        guard_len < 0 || (guard_len % PAGE_SIZE) != 0 ||
+        lo >= hi || hi - lo > (unsigned long)max_len ||
+        lo < USER_MEM_START || hi > USER_STACK_BASE) {
+        mutex_unlock(&(pcb->stack_mp));
+        report_error(tag, "bad stack region 0x%x-0x%x", lo, hi);
+        return -1;
+    }
+
+    /* the kernel windows (the vdso, the framebuffer, the scratch pages) are
+     * all above USER_STACK_BASE, and the limit and its guard must not wrap
+     * below USER_MEM_START
+     */
+    if ((unsigned long)max_len > hi - USER_MEM_START ||
+        (unsigned long)guard_len > hi - USER_MEM_START - max_len) {
+        mutex_unlock(&(pcb->stack_mp));
+        report_error(tag, "stack region 0x%x-0x%x reaches out of user memory",
+                     lo, hi);
+        return -1;
+    }
+
+    unsigned long limit = hi - max_len;
+
+    if (stack_region_collides(pcb, r, limit - guard_len, hi)) {
+        mutex_unlock(&(pcb->stack_mp));
+        report_error(tag, "stack region collides with another one");
+        return -1;
+    }
+
+    /* what the stack grew to before (an earlier thread on the same stack,
+     * or the swexn handler) stays part of it
+     */
+    while (lo > limit && pgd_get_frm(pgd, (void *)(lo - PAGE_SIZE)) != NULL)
+        lo -= PAGE_SIZE;
+
+    unsigned long addr;
+    for (addr = limit - guard_len; addr < lo; addr += PAGE_SIZE) {
+        if (pgd_get_frm(pgd, (void *)addr) != NULL ||
+            zswap_is_swapped(pgd, (void *)addr)) {
+            mutex_unlock(&(pcb->stack_mp));
+            report_error(tag, "0x%x below the stack is in use", addr);
+            return -1;
+        }
+    }
+
+    if (r == NULL) {
+        if ((r = malloc(sizeof(stack_region_t))) == NULL) {
+            mutex_unlock(&(pcb->stack_mp));
+            report_error(tag, "can't malloc stack region");
+            return -1;
+        }
+
+        r->tid = tid;
+        r->next = pcb->stack_regions;
+        pcb->stack_regions = r;
+    }
+
+    r->hi = hi;
+    r->lo = lo;
+    r->limit = limit;
+    r->guard = guard_len;
+
+    mutex_unlock(&(pcb->stack_mp));
+
+    report_progress(tag, "thread %d stack 0x%x-0x%x, limit 0x%x", tid,
+                    lo, hi, limit);
+    return 0;
+}
+
+void stack_region_remove(pcb_t *pcb, int tid)
+{
+    stack_region_t **pp;
+
+    mutex_lock(&(pcb->stack_mp));
+
+    for (pp = &(pcb->stack_regions); *pp != NULL; pp = &((*pp)->next)) {
+        if ((*pp)->tid == tid) {
+            stack_region_t *r = *pp;
+            *pp = r->next;
+            free(r);
+            break;
+        }
+    }
+
+    mutex_unlock(&(pcb->stack_mp));
+}
+
+int stack_region_save(pcb_t *pcb, int tid, stack_region_t *save)
+{
+    stack_region_t *r;
+
+    mutex_lock(&(pcb->stack_mp));
+
+    if ((r = stack_region_find(pcb, tid)) == NULL) {
+        mutex_unlock(&(pcb->stack_mp));
+        return -1;
+    }
+
+    *save = *r;
+    mutex_unlock(&(pcb->stack_mp));
+
+    save->next = NULL;
+    return 0;
+}
+
+int stack_region_restore(pcb_t *pcb, int tid, stack_region_t *save)
+{
+    stack_region_t *copy;
+
+    if ((copy = malloc(sizeof(stack_region_t))) == NULL) {
+        report_error(tag, "can't malloc stack region copy");
+        return -1;
+    }
+
+    *copy = *save;
+    copy->tid = tid;
+
+    mutex_lock(&(pcb->stack_mp));
+    copy->next = pcb->stack_regions;
+    pcb->stack_regions = copy;
+    mutex_unlock(&(pcb->stack_mp));
+
+    return 0;
+}
+
+int stack_region_copy(pcb_t *from, int from_tid, pcb_t *to, int to_tid)
+{
+    stack_region_t save;
+
+    /* nothing to copy */
+    if (stack_region_save(from, from_tid, &save) != 0)
+        return 0;
+
+    return stack_region_restore(to, to_tid, &save);
+}
+
+void stack_region_clear(pcb_t *pcb)
+{
+    stack_region_t *r;
+
+    mutex_lock(&(pcb->stack_mp));
+
+    while ((r = pcb->stack_regions) != NULL) {
+        pcb->stack_regions = r->next;
+        free(r);
+    }
+
+    mutex_unlock(&(pcb->stack_mp));
+}
+
+int stack_region_overlaps(pcb_t *pcb, unsigned long base, int len)
+{
+    int ret;
+
+    mutex_lock(&(pcb->stack_mp));
+    ret = stack_region_collides(pcb, NULL, base, base + len);
+    mutex_unlock(&(pcb->stack_mp));
+
+    return ret;
+}
+
+int stack_region_grow(pcb_t *pcb, int tid, unsigned long fault_addr)
+{
+    void *pgd = (void *)pcb->pgd;
+    stack_region_t *r;
+
+    mutex_lock(&(pcb->stack_mp));
+
+    r = stack_region_find(pcb, tid);
+    if (r == NULL || fault_addr < r->limit || fault_addr >= r->lo) {
+        mutex_unlock(&(pcb->stack_mp));
+        return -1;
+    }
+
+    /* map a few pages at once, a deep call chain keeps going down */
+    unsigned long new_lo = fault_addr & ~(PAGE_SIZE - 1);
+    if (r->lo - new_lo < STACK_GROW_PAGES * PAGE_SIZE) {
+        if (r->lo - r->limit < STACK_GROW_PAGES * PAGE_SIZE)
+            new_lo = r->limit;
+        else
+            new_lo = r->lo - STACK_GROW_PAGES * PAGE_SIZE;
+    }
+
+    if (pgd_alloc_pages(pgd, (void *)new_lo, r->lo - new_lo,
+                        PG_PRESENT | PG_WRITABLE | PG_USER,
+                        PG_PRESENT | PG_WRITABLE | PG_USER) != 0) {
+        /* short on memory, settle for what the fault needs */
+        new_lo = fault_addr & ~(PAGE_SIZE - 1);
+        if (pgd_alloc_pages(pgd, (void *)new_lo, r->lo - new_lo,
+                            PG_PRESENT | PG_WRITABLE | PG_USER,
+                            PG_PRESENT | PG_WRITABLE | PG_USER) != 0) {
+            mutex_unlock(&(pcb->stack_mp));
+            report_error(tag, "can't grow stack of thread %d to 0x%x", tid,
+                         fault_addr);
+            return -1;
+        }
+    }
+
+    memset((void *)new_lo, 0, r->lo - new_lo);
+    r->lo = new_lo;
+
+    mutex_unlock(&(pcb->stack_mp));
+
+    report_progress(tag, "grew stack of thread %d to 0x%x", tid, new_lo);
+    return 0;
+}
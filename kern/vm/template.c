@@ -0,0 +1,170 @@
+/** @file kern/vm/template.c
+ *
+ *  @brief process template table implementation
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <template.h>
+#include <common_include.h>
+#include <malloc.h>
+#include <reaper.h>
+
+static char *tag = "template";
+
+/* the templates by id, its mutex also guards the reference counts */
+static ht_t *template_ht = NULL;
+
+/* the next id to hand out */
+static int template_next_id = 1;
+
+/* the pid template_remove_owned looks for, under the table mutex */
+static int template_dead_owner;
+
+/** @brief the id compare function for the template table
+ *
+ *  @param e1 the first hash table entry
+ *  @param e2 the second hash table entry
+ *  @return 1 if equal, 0 if not
+ */
+static int key_compare_id(ht_entry_t *e1, ht_entry_t *e2)
+{
+    return (int)(e1->key) == (int)(e2->key);
+}
+
+/** @brief check if a template belongs to template_dead_owner, the table
+ *         mutex held
+ *
+ *  @param e the hash table entry
+ *  @return 1 if it does, 0 if not
+ */
+static int template_owned(ht_entry_t *e)
+{
+    return ((template_t *)e->value)->owner == template_dead_owner;
+}
+
+/** @brief free a template nobody references any more
+ *
+ *  @param t the template
+ *  @return Void
+ */
+static void template_free(template_t *t)
+{
+    report_progress(tag, "freeing template %d", t->id);
+
+    /* the frames go back like the ones of an exited process */
+    reaper_enqueue(t->pgd);
+
+    free(t->kstack);
+    free(t->regs);
+    free(t);
+}
+
+int template_init(void)
+{
+    if ((template_ht = ht_new((key_compare_fn) key_compare_id)) == NULL) {
+        report_error(tag, "template_init: can't alloc table");
+        return -1;
+    }
+
+    return 0;
+}
+
+int template_add(template_t *t)
+{
+    mutex_lock(&(template_ht->mp));
+
+    if (ht_size(template_ht) >= TEMPLATE_MAX) {
+        mutex_unlock(&(template_ht->mp));
+        report_error(tag, "template_add: table full");
+        return -1;
+    }
+
+    t->id = template_next_id++;
+    t->refs = 1;
+
+    if (ht_insert(template_ht, t->id, (void *)t) != 0) {
+        mutex_unlock(&(template_ht->mp));
+        report_error(tag, "template_add: can't insert");
+        return -1;
+    }
+
+    mutex_unlock(&(template_ht->mp));
+    return t->id;
+}
+
+template_t *template_get(int id)
+{
+    template_t *t;
+
+    mutex_lock(&(template_ht->mp));
+
+    if ((t = ht_lookup(template_ht, id)) != NULL)
+        t->refs++;
+
+    mutex_unlock(&(template_ht->mp));
+    return t;
+}
+
+void template_put(template_t *t)
+{
+    int last;
+
+    mutex_lock(&(template_ht->mp));
+    last = (--t->refs == 0);
+    mutex_unlock(&(template_ht->mp));
+
+    if (last)
+        template_free(t);
+}
+
+int template_remove(int id, int pid)
+{
+    template_t *t;
+
+    mutex_lock(&(template_ht->mp));
+
+    if ((t = ht_lookup(template_ht, id)) == NULL) {
+        mutex_unlock(&(template_ht->mp));
+        report_error(tag, "template_remove: no template %d", id);
+        return -1;
+    }
+
+    if (t->owner != pid) {
+        mutex_unlock(&(template_ht->mp));
+        report_error(tag, "template_remove: template %d is not process %d's",
+                     id, pid);
+        return -1;
+    }
+
+    ht_delete(template_ht, id);
+    mutex_unlock(&(template_ht->mp));
+
+    template_put(t);
+    return 0;
+}
+
+void template_remove_owned(int pid)
+{
+    template_t *t;
+
+    while (1) {
+        mutex_lock(&(template_ht->mp));
+
+        template_dead_owner = pid;
+        if ((t = ht_find(template_ht, template_owned)) != NULL)
+            ht_delete(template_ht, t->id);
+
+        mutex_unlock(&(template_ht->mp));
+
+        if (t == NULL)
+            break;
+
+        report_progress(tag, "template_remove_owned: dropping template %d "
+                        "of process %d", t->id, pid);
+
+        /* the spawns still using it keep it until they are done */
+        template_put(t);
+    }
+}
@@ -0,0 +1,74 @@
+/** @file kern/vm/vdso.c
+ *
+ *  @brief the page shared read only with every address space
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <vdso.h>
+#include <vm.h>
+#include <pgtable.h>
+#include <reporter.h>
+
+static char *tag = "vdso";
+
+/* the page, in the direct mapped kernel image, and its page table */
+static char vdso_page[PAGE_SIZE] __attribute__((aligned(PAGE_SIZE)));
+static void *vdso_pt[PAGE_SIZE / 4] __attribute__((aligned(PAGE_SIZE)));
+
+#define VDSO ((vdso_data_t *)vdso_page)
+
+/* the start of the current calibration window */
+static unsigned long long calib_tsc = 0;
+static unsigned int calib_ticks = 0;
+
+int vdso_init(void)
+{
+    if (kern_pgd == NULL) {
+        report_error(tag, "vdso_init: no kernel pgd yet");
+        return -1;
+    }
+
+    /* readable, not writable, from user space */
+    vdso_pt[GET_PT_INDEX(VDSO_ADDR)] =
+        (void *)((unsigned long)vdso_page | PG_PRESENT | PG_USER);
+
+    *(void **)(kern_pgd + 4 * VDSO_PGD_INDEX) =
+        (void *)((unsigned long)vdso_pt | PG_PRESENT | PG_USER);
+
+    report_progress(tag, "vdso_init: page %p mapped at 0x%x", vdso_page,
+                    VDSO_ADDR);
+    return 0;
+}
+
+void vdso_set_tick_usecs(unsigned int usecs)
+{
+    VDSO->usecs_per_tick = usecs;
+}
+
+void vdso_tick(unsigned int ticks)
+{
+    unsigned long long tsc = get_tsc();
+
+    VDSO->ticks = ticks;
+
+    if (calib_tsc == 0) {
+        calib_tsc = tsc;
+        calib_ticks = ticks;
+        return;
+    }
+
+    /* a window is short enough for its cycles to fit 32 bits */
+    if (ticks - calib_ticks == (1 << VDSO_CALIBRATE_SHIFT)) {
+        VDSO->tsc_per_tick =
+            (unsigned long)(tsc - calib_tsc) >> VDSO_CALIBRATE_SHIFT;
+        calib_tsc = tsc;
+        calib_ticks = ticks;
+    }
+}
+
+void vdso_set_tid(int tid)
+{
+    VDSO->tid = tid;
+}
@@ -18,6 +18,11 @@
 #include <pcb.h>
 #include <loader.h>
 #include <reporter.h>
+#include <zswap.h>
+#include <vdso.h>
+#include <console_fb.h>
+#include <futex.h>
+#include <if_flag.h>
 
 #define MIN(x, y) ((x) < (y) ? x : y)
 
@@ -35,8 +40,10 @@ int vm_ref_copy(void *pgd, void *new_pgd, int make_ro)
         return -1;
     }
 
-    /* copy the kernel page tables */
+    /* copy the kernel page tables, and the shared one of the vdso page */
     memcpy(new_pgd, pgd, 4*4);
+    *(void **)(new_pgd + 4 * VDSO_PGD_INDEX) = 
+        *(void **)(pgd + 4 * VDSO_PGD_INDEX);
 
     /* create new page tables (but use old frames) for user space */
     int pgd_index;
@@ -53,6 +60,11 @@ int vm_ref_copy(void *pgd, void *new_pgd, int make_ro)
     unsigned long frm_flags;
 
     for (pgd_index = 4; pgd_index < PAGE_SIZE / 4; pgd_index++) {
+        /* the vdso and the framebuffer page tables are shared */
+        if (pgd_index == VDSO_PGD_INDEX ||
+            pgd_index == CONSOLE_FB_PGD_INDEX)
+            continue;
+
         pgd_addr = pgd + 4 * pgd_index;
         pgd_entry = *(void **)pgd_addr;
         
@@ -76,6 +88,16 @@ int vm_ref_copy(void *pgd, void *new_pgd, int make_ro)
             pt_addr = pt + 4 * pt_index;
             pt_entry = *(void **)pt_addr;
 
+            /* a swapped out page is shared through its pool slot, each
+             * side decompresses its own copy on fault
+             */
+            if (IS_SWAPPED(pt_entry)) {
+                zswap_dup(SWAP_SLOT(pt_entry));
+                *(void **)(new_pt + 4 * pt_index) = pt_entry;
+                PGD_ACCT_ADD(new_pgd, swapped, 1);
+                continue;
+            }
+
             frm = GET_ADDRESS(pt_entry);
             frm_flags = GET_FLAGS((unsigned long)pt_entry);
 
@@ -83,9 +105,12 @@ int vm_ref_copy(void *pgd, void *new_pgd, int make_ro)
                 continue;
             }
     
-            /* if make readonly, rid writable flag off */
+            /* if make readonly, rid writable flag off and mark the page
+             * copy-on-write on both sides
+             */
             if (make_ro) {
                 frm_flags &= (~PG_WRITABLE);
+                frm_flags |= PG_COW;
             }
 
             /* use the same frame */
@@ -135,6 +160,11 @@ void vm_ref_copy_rollback(void *pgd)
     unsigned long pt_flags;
 
     for (pgd_index = 4; pgd_index < PAGE_SIZE / 4; pgd_index++) {
+        /* the vdso and the framebuffer page tables are shared */
+        if (pgd_index == VDSO_PGD_INDEX ||
+            pgd_index == CONSOLE_FB_PGD_INDEX)
+            continue;
+
         pgd_addr = pgd + 4 * pgd_index;
         pgd_entry = *(void **)pgd_addr;
 
@@ -175,6 +205,7 @@ int vm_frm_copy(void *pgd, void *linear_addr, int make_writable)
 
     int ref_count;
     void *new_frm_addr;
+    int if_was_set;
 
     pgd_index = GET_PGD_INDEX(linear_addr);
     pt_index = GET_PT_INDEX(linear_addr);
@@ -205,14 +236,28 @@ int vm_frm_copy(void *pgd, void *linear_addr, int make_writable)
 
         if (make_writable) {
             /* last frame, just make itself writable */
-            *(void **)pt_addr = ADD_FLAGS(pt_entry, frm_flags | PG_WRITABLE);
+            *(void **)pt_addr = ADD_FLAGS(pt_entry, 
+                                (frm_flags | PG_WRITABLE) & ~PG_COW);
             set_cr3((unsigned long)pgd);
+
+            if (frm_flags & PG_COW)
+                PGD_ACCT_ADD(pgd, shared, -1);
         }
         mutex_unlock(&(frm_ref_mp));
 
+        /* the other sharers are gone, this pgd owns the frame now */
+        frame_set_owner(frm, pgd, GET_ADDRESS(linear_addr));
+
         return 0;
     }
 
+    /* the private copy is charged against the frame limit */
+    if (!pgd_acct_may_grow(pgd, 1)) {
+        mutex_unlock(&(frm_ref_mp));
+        report_warning(tag, "vm_frm_copy: over the frame limit, exit");
+        return -1;
+    }
+
     set_frame_refs(frm, ref_count - 1);
     mutex_unlock(&(frm_ref_mp));
 
@@ -221,9 +266,17 @@ int vm_frm_copy(void *pgd, void *linear_addr, int make_writable)
         pt_flags |= PG_WRITABLE;
         frm_flags |= PG_WRITABLE;
     }
+    frm_flags &= ~PG_COW;
 
-    if (pgd_insert(pgd, LAST_PAGE_ADDR, pt_flags, frm_flags, NULL) < 0) {
+    /* the temp page is kernel only, so it is not charged to the pgd */
+    if (pgd_insert(pgd, LAST_PAGE_ADDR, PG_PRESENT | PG_WRITABLE, 
+                   PG_PRESENT | PG_WRITABLE, NULL) < 0) {
         report_error(tag, "vm_frm_copy: can't allocate temp page, exit");
+
+        /* give the reference back */
+        mutex_lock(&(frm_ref_mp));
+        set_frame_refs(frm, get_frame_refs(frm) + 1);
+        mutex_unlock(&(frm_ref_mp));
         return -1;
     }
 
@@ -232,17 +285,27 @@ int vm_frm_copy(void *pgd, void *linear_addr, int make_writable)
     memcpy((void *)LAST_PAGE_ADDR, GET_LINEAR_ADDR(pgd_index, pt_index),
             PAGE_SIZE);
 
-    pt_entry_delete(pgd, linear_addr, 0);
     report_progress(tag, "vm_frm_copy: memcpy to LAST_PAGE done");
 
     new_frm_addr = pgd_get_frm(pgd, LAST_PAGE_ADDR);
 
+    /* futex waiters must not see the page between the two frames */
+    if_was_set = if_disable();
+
+    pt_entry_delete(pgd, linear_addr, 0);
+
     if (pgd_insert(pgd, linear_addr, pt_flags, frm_flags, new_frm_addr) < 0) {
+        if_recover(if_was_set);
         report_error(tag, 
                     "vm_frm_copy: cannot insert new frame into pgd, exit");
         return -1;
     }
 
+    futex_rekey(pgd, frm, new_frm_addr);
+    if_recover(if_was_set);
+
+    frame_set_owner(new_frm_addr, pgd, GET_ADDRESS(linear_addr));
+
     if (pt_entry_delete(pgd, LAST_PAGE_ADDR, 1) == NULL) {
         report_error(tag, 
                 "vm_frm_copy: cannot delete new frame from last page, exit");
@@ -292,6 +355,11 @@ int vm_init(void)
         report_error(tag, "kernel frame initialization failed in vm_init");
         return -1;
     }
+
+    if (zswap_init() != 0) {
+        report_error(tag, "swap pool initialization failed in vm_init");
+        return -1;
+    }
     
     vm_set_cr3(kern_pgd);
     vm_enable_paging();
@@ -0,0 +1,495 @@
+/** @file kern/vm/zswap.c
+ *
+ *  @brief compressed swap to a RAM pool
+ *
+ *  The clock hand walks the user frames in physical order. A frame can be
+ *  swapped out when exactly one entry maps it (reference count 1, see
+ *  frame_get_owner) and its accessed bit stayed clear since the hand last
+ *  passed. The dirty bit is cleared before compressing and checked again
+ *  with interrupts disabled before the entry is replaced, so a write that
+ *  races with compression simply cancels the swap out.
+ *
+ *  All pool state, and the scratch window, is protected by zswap_mp. Frames
+ *  are always allocated before zswap_mp is taken, since allocating may need
+ *  to reclaim.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <zswap.h>
+#include <lz.h>
+#include <pgtable.h>
+#include <frame.h>
+#include <vm.h>
+#include <loader.h>
+#include <mutex.h>
+#include <asm.h>
+#include <if_flag.h>
+#include <futex.h>
+#include <reporter.h>
+#include <x86/cr.h>
+
+/* a compressed page in the pool */
+typedef struct zswap_slot {
+    /* the compressed bytes, NULL for a page of zeros */
+    void *data;
+    int len;
+
+    /* the number of swap entries referring to this slot */
+    int refs;
+} zswap_slot_t;
+
+static zswap_slot_t slots[ZSWAP_MAX_SLOTS];
+
+/* stack of free slot numbers */
+static int free_slots[ZSWAP_MAX_SLOTS];
+static int free_top;
+
+/* the next frame index the clock looks at */
+static int clock_hand;
+
+static zswap_stats_t stats;
+
+static mutex_t zswap_mp;
+
+static int zswap_ready = 0;
+
+/* compression scratch space, used under zswap_mp */
+static unsigned short lz_table[LZ_TABLE_SIZE];
+static unsigned char zbuf[ZSWAP_MAX_STORE];
+
+static char *tag = "zswap";
+
+int zswap_init(void)
+{
+    int slot;
+
+    if (mutex_init(&zswap_mp) != 0) {
+        report_error(tag, "zswap_init: failed to init zswap_mp");
+        return -1;
+    }
+
+    free_top = 0;
+    for (slot = ZSWAP_MAX_SLOTS - 1; slot > 0; slot--) {
+        free_slots[free_top++] = slot;
+    }
+
+    clock_hand = 0;
+    zswap_ready = 1;
+
+    return 0;
+}
+
+/** @brief map a frame at the scratch window of the pgd in cr3
+ *
+ *  @param cur_pgd the pgd in cr3
+ *  @param frm the frame
+ *  @return the window on success, NULL on error
+ */
+static void *scratch_map(void *cur_pgd, void *frm)
+{
+    if (pgd_insert(cur_pgd, ZSWAP_SCRATCH_ADDR, PG_PRESENT | PG_WRITABLE,
+                   PG_PRESENT | PG_WRITABLE, frm) != 0) {
+        report_error(tag, "scratch_map: cannot map %p", frm);
+        return NULL;
+    }
+
+    invalidate_page(ZSWAP_SCRATCH_ADDR);
+    return ZSWAP_SCRATCH_ADDR;
+}
+
+/** @brief unmap the scratch window, but keep its page table
+ *
+ *  @param cur_pgd the pgd in cr3
+ *  @return Void
+ */
+static void scratch_unmap(void *cur_pgd)
+{
+    pt_entry_delete(cur_pgd, ZSWAP_SCRATCH_ADDR, 0);
+    invalidate_page(ZSWAP_SCRATCH_ADDR);
+}
+
+/** @brief check if a page only holds zeros
+ *
+ *  @param page the page
+ *  @return 1 if so, 0 if not
+ */
+static int page_is_zero(void *page)
+{
+    unsigned long *word = page;
+    int i;
+
+    for (i = 0; i < PAGE_SIZE / sizeof(unsigned long); i++) {
+        if (word[i] != 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+/** @brief release a reference on a slot, zswap_mp held
+ *
+ *  @param slot the slot
+ *  @return Void
+ */
+static void slot_release(int slot)
+{
+    zswap_slot_t *s = &slots[slot];
+
+    if (slot <= 0 || slot >= ZSWAP_MAX_SLOTS || s->refs <= 0) {
+        report_error(tag, "slot_release: bad slot %d", slot);
+        return;
+    }
+
+    if (--s->refs > 0)
+        return;
+
+    if (s->data != NULL)
+        free(s->data);
+
+    stats.stored_pages--;
+    stats.stored_bytes -= s->len;
+
+    s->data = NULL;
+    s->len = 0;
+    free_slots[free_top++] = slot;
+}
+
+/** @brief try to swap out one frame, zswap_mp held
+ *
+ *  @param cur_pgd the pgd in cr3
+ *  @param frm the frame under the clock hand
+ *  @return 1 if the frame got freed, 0 if skipped, -1 if the pool is full
+ */
+static int zswap_try_out(void *cur_pgd, void *frm)
+{
+    void *pgd, *linear_addr;
+    void *owner_pgd, *owner_addr;
+    void **pte;
+    void *page;
+    void *data = NULL;
+    unsigned long entry, clean;
+    int refs, len, slot, if_was_set;
+
+    if (frame_get_owner(frm, &pgd, &linear_addr) != 0)
+        return 0;
+
+    /* the process exited, its pgd is being torn down */
+    if (PGD_ACCT(pgd)->dying)
+        return 0;
+
+    /* only user pages, never the temporary windows above the stack */
+    if ((unsigned long)linear_addr < USER_MEM_START ||
+        (unsigned long)linear_addr >= USER_STACK_BASE)
+        return 0;
+
+    /* a shared (COW) frame has no single entry to replace */
+    mutex_lock(&frm_ref_mp);
+    refs = get_frame_refs(frm);
+    mutex_unlock(&frm_ref_mp);
+
+    if (refs != 1)
+        return 0;
+
+    if ((pte = pgd_get_pte(pgd, linear_addr)) == NULL)
+        return 0;
+
+    entry = (unsigned long)*pte;
+    if (!PG_IS_PRESENT(entry) || GET_ADDRESS(entry) != frm ||
+        !IS_USER(entry))
+        return 0;
+
+    /* second chance, come back on the next sweep */
+    if (IS_ACCESSED(entry)) {
+        *pte = (void *)(entry & ~PG_ACCESSED);
+        if (pgd == cur_pgd)
+            invalidate_page(linear_addr);
+        return 0;
+    }
+
+    /* clear dirty as well, so a write racing with us can be noticed */
+    clean = entry & ~PG_DIRTY;
+    *pte = (void *)clean;
+    if (pgd == cur_pgd)
+        invalidate_page(linear_addr);
+
+    if ((page = scratch_map(cur_pgd, frm)) == NULL)
+        return 0;
+
+    if (page_is_zero(page))
+        len = 0;
+    else
+        len = lz_compress(page, PAGE_SIZE, zbuf, ZSWAP_MAX_STORE, lz_table);
+
+    scratch_unmap(cur_pgd);
+
+    if (len < 0) {
+        stats.rejected++;
+        return 0;
+    }
+
+    if (free_top == 0 || stats.stored_bytes + len > ZSWAP_POOL_LIMIT) {
+        report_warning(tag, "zswap_try_out: pool is full");
+        return -1;
+    }
+
+    if (len > 0) {
+        if ((data = malloc(len)) == NULL) {
+            report_warning(tag, "zswap_try_out: cannot malloc %d bytes", len);
+            return -1;
+        }
+        memcpy(data, zbuf, len);
+    }
+
+    slot = free_slots[--free_top];
+
+    /* replace the entry only if nobody touched or remapped the page, and
+     * nobody waits on a futex in it (the key is the frame)
+     */
+    if_was_set = if_disable();
+
+    if (frame_get_owner(frm, &owner_pgd, &owner_addr) != 0 ||
+        owner_pgd != pgd || owner_addr != linear_addr ||
+        (unsigned long)*pte != clean || futex_frame_busy(frm)) {
+
+        if_recover(if_was_set);
+
+        free_slots[free_top++] = slot;
+        if (data != NULL)
+            free(data);
+        return 0;
+    }
+
+    *pte = SWAP_ENTRY(slot, clean);
+    if (pgd == cur_pgd)
+        invalidate_page(linear_addr);
+
+    if_recover(if_was_set);
+
+    PGD_ACCT_ADD(pgd, resident, -1);
+    PGD_ACCT_ADD(pgd, swapped, 1);
+    if (clean & PG_COW)
+        PGD_ACCT_ADD(pgd, shared, -1);
+
+    slots[slot].data = data;
+    slots[slot].len = len;
+    slots[slot].refs = 1;
+
+    stats.stored_pages++;
+    stats.stored_bytes += len;
+    stats.pages_out++;
+
+    mutex_lock(&frm_mp);
+    frame_free(frm);
+    mutex_unlock(&frm_mp);
+
+    return 1;
+}
+
+int zswap_reclaim(int target)
+{
+    if (!zswap_ready || target <= 0)
+        return 0;
+
+    void *cur_pgd = GET_ADDRESS(get_cr3());
+
+    /* the scratch window must not land in kern_pgd, every new pgd starts
+     * as a copy of it
+     */
+    if (cur_pgd == kern_pgd)
+        return 0;
+
+    int total = frame_get_total();
+    int budget = 2 * total;
+    int freed = 0;
+    int ret;
+
+    mutex_lock(&zswap_mp);
+
+    while (freed < target && budget-- > 0) {
+        ret = zswap_try_out(cur_pgd, frame_by_index(clock_hand));
+        clock_hand = (clock_hand + 1) % total;
+
+        if (ret < 0)
+            break;
+
+        freed += ret;
+    }
+
+    mutex_unlock(&zswap_mp);
+
+    report_progress(tag, "zswap_reclaim: freed %d of %d frames",
+                    freed, target);
+
+    return freed;
+}
+
+int zswap_is_swapped(void *pgd, void *linear_addr)
+{
+    void **pte = pgd_get_pte(pgd, linear_addr);
+
+    return pte != NULL && IS_SWAPPED(*pte);
+}
+
+int zswap_fault_in(void *pgd, void *linear_addr)
+{
+    unsigned long long start = get_tsc();
+    unsigned long long cycles;
+    unsigned long entry;
+    void **pte;
+    void *frm, *page;
+    int slot;
+
+    linear_addr = GET_ADDRESS(linear_addr);
+
+    /* take the frame first, reclaiming needs zswap_mp */
+    if ((frm = frame_alloc_reclaim()) == NULL) {
+        report_error(tag, "zswap_fault_in: no frame for %p", linear_addr);
+        return -1;
+    }
+
+    mutex_lock(&zswap_mp);
+
+    pte = pgd_get_pte(pgd, linear_addr);
+    if (pte == NULL || !IS_SWAPPED(*pte)) {
+        /* another thread of the process got here first */
+        mutex_unlock(&zswap_mp);
+
+        mutex_lock(&frm_mp);
+        frame_free(frm);
+        mutex_unlock(&frm_mp);
+
+        return (pte == NULL) ? -1 : 0;
+    }
+
+    entry = (unsigned long)*pte;
+    slot = SWAP_SLOT(entry);
+
+    if ((page = scratch_map(pgd, frm)) == NULL) {
+        mutex_unlock(&zswap_mp);
+
+        mutex_lock(&frm_mp);
+        frame_free(frm);
+        mutex_unlock(&frm_mp);
+
+        return -1;
+    }
+
+    if (slots[slot].data == NULL) {
+        memset(page, 0, PAGE_SIZE);
+    }
+    else if (lz_decompress(slots[slot].data, slots[slot].len, page,
+                           PAGE_SIZE) != PAGE_SIZE) {
+        report_error(tag, "zswap_fault_in: slot %d is corrupted", slot);
+        scratch_unmap(pgd);
+        mutex_unlock(&zswap_mp);
+
+        mutex_lock(&frm_mp);
+        frame_free(frm);
+        mutex_unlock(&frm_mp);
+
+        return -1;
+    }
+
+    scratch_unmap(pgd);
+
+    /* the page is complete, publish it */
+    *pte = (void *)((unsigned long)frm | PG_PRESENT |
+                    (entry & (PG_WRITABLE | PG_USER)));
+    invalidate_page(linear_addr);
+
+    PGD_ACCT_ADD(pgd, resident, 1);
+    PGD_ACCT_ADD(pgd, swapped, -1);
+
+    frame_set_owner(frm, pgd, linear_addr);
+    slot_release(slot);
+
+    cycles = get_tsc() - start;
+    stats.pages_in++;
+    stats.in_cycles += cycles;
+    if (cycles > stats.in_cycles_max)
+        stats.in_cycles_max = cycles;
+
+    mutex_unlock(&zswap_mp);
+
+    return 0;
+}
+
+int zswap_drop(void *pgd, void *linear_addr)
+{
+    void **pte;
+    int dropped = 0;
+
+    mutex_lock(&zswap_mp);
+
+    pte = pgd_get_pte(pgd, linear_addr);
+    if (pte != NULL && IS_SWAPPED(*pte)) {
+        slot_release(SWAP_SLOT(*pte));
+        *pte = NULL;
+        PGD_ACCT_ADD(pgd, swapped, -1);
+        dropped = 1;
+    }
+
+    mutex_unlock(&zswap_mp);
+
+    return dropped;
+}
+
+void zswap_dup(int slot)
+{
+    mutex_lock(&zswap_mp);
+    slots[slot].refs++;
+    mutex_unlock(&zswap_mp);
+}
+
+void zswap_put(int slot)
+{
+    mutex_lock(&zswap_mp);
+    slot_release(slot);
+    mutex_unlock(&zswap_mp);
+}
+
+void zswap_barrier(void)
+{
+    /* zswap_reclaim holds zswap_mp for the whole sweep */
+    mutex_lock(&zswap_mp);
+    mutex_unlock(&zswap_mp);
+}
+
+void zswap_get_stats(zswap_stats_t *s)
+{
+    mutex_lock(&zswap_mp);
+    *s = stats;
+    mutex_unlock(&zswap_mp);
+}
+
+void zswap_report(void)
+{
+    zswap_stats_t s;
+    unsigned long ratio;
+    unsigned long long cycles;
+    unsigned long pages;
+
+    zswap_get_stats(&s);
+
+    /* ratio is in hundredths, the pool is small enough not to overflow */
+    ratio = (s.stored_bytes == 0) ? 0 :
+            s.stored_pages * PAGE_SIZE * 100 / s.stored_bytes;
+
+    /* scale down until a 32-bit division does, good enough for a report */
+    cycles = s.in_cycles;
+    pages = s.pages_in;
+    while ((cycles >> 32) != 0) {
+        cycles >>= 1;
+        pages >>= 1;
+    }
+
+    lprintf("zswap: %lu pages in %lu bytes, ratio %lu.%02lu",
+            s.stored_pages, s.stored_bytes, ratio / 100, ratio % 100);
+    lprintf("zswap: %lu out, %lu in, %lu rejected",
+            s.pages_out, s.pages_in, s.rejected);
+    lprintf("zswap: fault-in %lu cycles avg, %lu cycles max",
+            (pages == 0) ? 0 : (unsigned long)cycles / pages,
+            (unsigned long)s.in_cycles_max);
+}
@@ -11,5 +11,6 @@
 extern void *root_stack_lo;     /* the low address of root stack */
 extern void *root_stack_hi;     /* the high address of root stack */
 extern void *exn_stack_base;    /* the exception stack base */
+extern int autostack_in_kernel; /* the kernel grows the stacks */
 
 #endif
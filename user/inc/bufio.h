@@ -0,0 +1,81 @@
+/** @file bufio.h
+ *
+ *  @brief buffered print for user programs
+ *
+ *  Every thread writes into a buffer of its own and the buffer goes out in
+ *  a single print when it fills, on a newline (line buffered) or when it is
+ *  flushed. The buffers are flushed before fork, exec, readline, getchar
+ *  and task_vanish, and the buffer of a thread before its vanish (so before
+ *  exit and thr_exit too).
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _BUFIO_H
+#define _BUFIO_H
+
+/* the buffering modes */
+#define BUFIO_UNBUFFERED 0  /* print at the end of every call */
+#define BUFIO_LINE 1        /* print on a newline or a full buffer */
+#define BUFIO_FULL 2        /* print on a full buffer only */
+
+/* the length of the buffer of a thread, also the most one bufio_printf
+ * writes
+ */
+#define BUFIO_LEN 1024
+
+/* the most threads with a buffer at once, the rest print unbuffered */
+#define BUFIO_NBUFS 64
+
+/** @brief set the buffering mode of the calling thread, BUFIO_LINE until
+ *         it is set
+ *
+ *  @param mode BUFIO_UNBUFFERED, BUFIO_LINE or BUFIO_FULL
+ *  @return the previous mode, -1 on an invalid mode
+ */
+int bufio_setmode(int mode);
+
+/** @brief write len bytes to the buffer of the calling thread
+ *
+ *  @param buf the bytes
+ *  @param len the length
+ *  @return 0 on success, -1 on error
+ */
+int bufio_write(const char *buf, int len);
+
+/** @brief write a char to the buffer of the calling thread
+ *
+ *  @param c the char
+ *  @return c
+ */
+int bufio_putchar(int c);
+
+/** @brief format straight into the buffer of the calling thread
+ *
+ *  @param fmt the format, as printf
+ *  @return the number of chars written
+ */
+int bufio_printf(const char *fmt, ...);
+
+/** @brief print what the calling thread has buffered
+ *
+ *  @return 0 on success, -1 on error
+ */
+int bufio_flush(void);
+
+/** @brief print what every thread has buffered. The libsyscall stubs call it
+ *         before fork, exec, readline, getchar and task_vanish
+ *
+ *  @return Void
+ */
+void bufio_flush_all(void);
+
+/** @brief print what the calling thread has buffered and give up its
+ *         buffer. The vanish stub calls it
+ *
+ *  @return Void
+ */
+void bufio_release(void);
+
+#endif /* _BUFIO_H */
@@ -9,12 +9,10 @@
 #ifndef _COND_TYPE_H
 #define _COND_TYPE_H
 
-#include <queue.h>
-
 typedef struct cond {
     char init;      /* indicate initialization */
-    queue wait_tids;    /* the queue of threads waiting */
-    mutex_t lock;   /* used to protect the data of cond struct */
+    int seq;        /* bumped by every signal, waiters futex_wait on it */
+    int waiters;    /* the # threads waiting */
 } cond_t;
 
 #endif /* _COND_TYPE_H */
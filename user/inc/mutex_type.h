@@ -9,10 +9,14 @@
 #define _MUTEX_TYPE_H
 
 
+/* the states of a mutex, waiters sleep in futex_wait on it */
+#define MUTEX_UNLOCKED 0
+#define MUTEX_LOCKED 1
+#define MUTEX_CONTENDED 2
+
 typedef struct mutex {  
     char init;          /* indicate if a mutex is initialized */
-    int threads_count;  /* indicate the # threads that's waiting on mutex */
-    int available;      /* indicate if the mutex is available */
+    int state;          /* unlocked, locked, or locked with waiters */
 } mutex_t;
 
 #endif /* _MUTEX_TYPE_H */
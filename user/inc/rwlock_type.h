@@ -8,21 +8,17 @@
 #ifndef _RWLOCK_TYPE_H
 #define _RWLOCK_TYPE_H
 
-#include <sem.h>
 #include <mutex.h>
-#include <splay_tree.h>
+#include <cond.h>
 
 typedef struct rwlock {
     char init;          /* indicate if a rwlock is initialized */
     int read_count;     /* indicate the number of readers */
+    int writer;         /* indicate if a writer holds the lock */
+    int write_waiting;  /* indicate the number of writers waiting */
 
-    splay_tree rw_tids; /* stores the thr_key of writers in a splay tree */
-
-    sem_t enter_mutex;  /* sem for entering the reading area */
-    sem_t rw_mutex;     /* sem for writers */
-
-    sem_t mutex;        /* sem for enter and exit the reader session */
-    mutex_t st_mp;      /* mutex for accessing splay tree */
+    mutex_t mp;         /* mutex for the fields above */
+    cond_t cv;          /* waiting readers and writers */
 } rwlock_t;
 
 #endif /* _RWLOCK_TYPE_H */
@@ -8,14 +8,10 @@
 #ifndef _SEM_TYPE_H
 #define _SEM_TYPE_H
 
-#include <mutex.h>
-#include <cond.h>
-
 typedef struct sem {
     char init;      /* indicate if a sem is initialized */ 
-    int count;      /* the available count of semaphore */
-    cond_t cv;      /* the conditional variable for blocking threads */
-    mutex_t mp;     /* the mutex for updating count */
+    int count;      /* the available count, waiters futex_wait on it */
+    int waiters;    /* the # threads waiting */
 } sem_t;
 
 #endif /* _SEM_TYPE_H */
@@ -0,0 +1,429 @@
+/** @file user/inc/syscall_ext.h
+ *
+ *  @brief syscalls this kernel offers on top of the 410 spec. The trap
+ *         numbers and types match kern/inc/syscall_ext.h.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#ifndef _USER_INC_SYSCALL_EXT_H_
+#define _USER_INC_SYSCALL_EXT_H_
+
+#define SET_MEM_LIMIT_INT 0x80
+#define GET_MEM_USAGE_INT 0x81
+#define STACK_REGION_INT 0x82
+#define SPAWN_INT 0x83
+#define TEMPLATE_FREEZE_INT 0x84
+#define TEMPLATE_SPAWN_INT 0x85
+#define TEMPLATE_DROP_INT 0x86
+#define RING_SETUP_INT 0x87
+#define RING_ENTER_INT 0x88
+#define FUTEX_WAIT_INT 0x89
+#define FUTEX_WAKE_INT 0x8a
+#define SYSCALL_STATS_INT 0x8b
+#define CONSOLE_MODE_INT 0x8c
+#define SET_VTERM_INT 0x8d
+#define BLIT_CELLS_INT 0x8e
+#define CONSOLE_MAP_INT 0x8f
+#define POLL_INT 0x90
+#define PRINT_FLUSH_INT 0x91
+
+/* syscall numbers of the SYSENTER entry (in %eax). fork, thread_fork and
+ * template_freeze copy the trap frame of the int path, they have no number
+ */
+#define SYS_EXEC 0
+#define SYS_WAIT 1
+#define SYS_YIELD 2
+#define SYS_DESCHEDULE 3
+#define SYS_MAKE_RUNNABLE 4
+#define SYS_GETTID 5
+#define SYS_NEW_PAGES 6
+#define SYS_REMOVE_PAGES 7
+#define SYS_SLEEP 8
+#define SYS_GETCHAR 9
+#define SYS_READLINE 10
+#define SYS_PRINT 11
+#define SYS_SET_TERM_COLOR 12
+#define SYS_SET_CURSOR_POS 13
+#define SYS_GET_CURSOR_POS 14
+#define SYS_GET_TICKS 15
+#define SYS_MISBEHAVE 16
+#define SYS_HALT 17
+#define SYS_TASK_VANISH 18
+#define SYS_SET_STATUS 19
+#define SYS_VANISH 20
+#define SYS_READFILE 21
+#define SYS_SWEXN 22
+#define SYS_SET_MEM_LIMIT 23
+#define SYS_GET_MEM_USAGE 24
+#define SYS_STACK_REGION 25
+#define SYS_SPAWN 26
+#define SYS_TEMPLATE_SPAWN 27
+#define SYS_TEMPLATE_DROP 28
+#define SYS_RING_SETUP 29
+#define SYS_RING_ENTER 30
+#define SYS_FUTEX_WAIT 31
+#define SYS_FUTEX_WAKE 32
+#define SYS_SYSCALL_STATS 33
+#define SYS_CONSOLE_MODE 34
+#define SYS_SET_VTERM 35
+#define SYS_BLIT_CELLS 36
+#define SYS_CONSOLE_MAP 37
+#define SYS_POLL 38
+#define SYS_PRINT_FLUSH 39
+#define SYSENTER_NSYS 40
+
+/* what futex_wait returns besides 0 */
+#define FUTEX_EAGAIN (-2)
+#define FUTEX_ETIMEDOUT (-3)
+
+/* the console modes of console_mode */
+#define CONSOLE_MODE_SYNC 0
+#define CONSOLE_MODE_DEFERRED 1
+
+/* the serial modes of console_mode: keep the output of the foreground
+ * terminal off the serial port, copy it there, or send it there only
+ */
+#define CONSOLE_SERIAL_OFF 0x10
+#define CONSOLE_SERIAL_MIRROR 0x11
+#define CONSOLE_SERIAL_REDIRECT 0x12
+
+/* the virtual terminals of set_vterm, Alt+F1 to Alt+F4 show one */
+#define NVTERMS 4
+
+/* where console_map maps the cells of a terminal, CONSOLE_FB_ROWS rows of
+ * CONSOLE_FB_COLS cells, and a cell of character ch in color (the
+ * set_term_color colors), for console_map and blit_cells
+ */
+#define CONSOLE_FB_ADDR 0xff000000
+#define CONSOLE_FB_ROWS 25
+#define CONSOLE_FB_COLS 80
+#define CONSOLE_CELL_OF(ch, color) \
+    ((unsigned short)((((color) & 0xff) << 8) | ((ch) & 0xff)))
+
+/* the event sources of poll, and the most events one call takes */
+#define POLL_CONSOLE 0
+#define POLL_CHILD 1
+#define POLL_TIMER 2
+#define POLL_MAX_EVENTS 16
+
+/* the read only page the kernel keeps up to date in every address space,
+ * and the addresses of its fields (see vdso_data_t)
+ */
+#define VDSO_ADDR 0xff400000
+#define VDSO_TICKS (VDSO_ADDR + 0)
+#define VDSO_TSC_PER_TICK (VDSO_ADDR + 4)
+#define VDSO_USECS_PER_TICK (VDSO_ADDR + 8)
+#define VDSO_TID (VDSO_ADDR + 12)
+
+#ifndef ASSEMBLER
+
+/* the layout of the page at VDSO_ADDR */
+typedef struct vdso_data {
+    /* the timer ticks since boot, what get_ticks returns */
+    volatile unsigned int ticks;
+
+    /* time stamp counter cycles per tick, 0 until first calibrated */
+    volatile unsigned int tsc_per_tick;
+
+    /* the length of a tick in microseconds */
+    volatile unsigned int usecs_per_tick;
+
+    /* the tid of the running thread. There is a single cpu, so whoever
+     * reads it is the thread running
+     */
+    volatile int tid;
+} vdso_data_t;
+
+/* an event for poll */
+typedef struct poll_event {
+    /* POLL_CONSOLE, POLL_CHILD or POLL_TIMER */
+    int type;
+
+    /* the get_ticks() value a POLL_TIMER is ready at, unused otherwise */
+    unsigned int arg;
+
+    /* set by poll, 1 if the event is ready, 0 if not */
+    int revents;
+} poll_event_t;
+
+/* the memory usage of the calling process, in pages */
+typedef struct mem_usage {
+    /* present user pages */
+    int resident;
+
+    /* present user pages still shared copy-on-write */
+    int shared;
+
+    /* user pages compressed into the swap pool */
+    int swapped;
+
+    /* page tables of the user region */
+    int pt_pages;
+
+    /* most private (resident - shared) frames allowed, 0 for no limit */
+    int max_frames;
+
+    /* COW write faults fault-around saved, this process and everyone */
+    int faults_saved;
+    int faults_saved_all;
+} mem_usage_t;
+
+/* a submission: what the stub of syscall op would put in esi */
+typedef struct ring_sqe {
+    /* the SYS_* number of the syscall */
+    int op;
+
+    /* the argument, the packet address or the single value */
+    int arg;
+
+    /* handed back untouched in the completion */
+    unsigned int user_data;
+    int pad;
+} ring_sqe_t;
+
+/* a completion */
+typedef struct ring_cqe {
+    /* the user_data of the submission */
+    unsigned int user_data;
+
+    /* what the syscall returned */
+    int res;
+} ring_cqe_t;
+
+/* the head of a ring, the two queues follow it. The indexes only grow,
+ * slot i of a queue is i & (entries - 1). User space moves sq_tail and
+ * cq_head, the kernel sq_head and cq_tail.
+ */
+typedef struct ring {
+    volatile unsigned int sq_head;
+    volatile unsigned int sq_tail;
+    volatile unsigned int cq_head;
+    volatile unsigned int cq_tail;
+} ring_t;
+
+/* the queues of a ring, and its size */
+#define RING_SQES(r) ((ring_sqe_t *)((ring_t *)(r) + 1))
+#define RING_CQES(r, entries) ((ring_cqe_t *)(RING_SQES(r) + (entries)))
+#define RING_SIZE(entries) (sizeof(ring_t) + \
+                            (entries) * (sizeof(ring_sqe_t) + \
+                                         sizeof(ring_cqe_t)))
+
+/* the most slots in a queue */
+#define RING_MAX_ENTRIES 1024
+
+/* the log2 latency buckets of a syscall, the last one takes the rest */
+#define SYSCALL_STAT_BUCKETS 32
+
+/* the statistics of one syscall (see syscall_stats), indexed by SYS_
+ * number. A call is counted when it returns, so vanish and a successful
+ * exec never are; fork, thread_fork and template_freeze have no number.
+ */
+typedef struct syscall_stat {
+    /* calls made */
+    unsigned int calls;
+
+    /* calls that returned a negative number */
+    unsigned int errors;
+
+    /* TSC cycles from entering the handler to leaving it, blocking
+     * included
+     */
+    unsigned long long total_cycles;
+    unsigned long long max_cycles;
+
+    /* hist[i] counts the calls that took [2^i, 2^(i+1)) cycles */
+    unsigned int hist[SYSCALL_STAT_BUCKETS];
+} syscall_stat_t;
+
+/** @brief limit the private frames of the calling process. The limit is
+ *         inherited by fork and kept across exec. Pages still shared
+ *         copy-on-write are charged to nobody until they get copied.
+ *
+ *  @param frames the most private frames allowed, 0 for no limit
+ *  @return 0 on success, a negative number on error
+ */
+int set_mem_limit(int frames);
+
+/** @brief get the memory usage of the calling process
+ *
+ *  @param usage where to store the usage
+ *  @return 0 on success, a negative number on error
+ */
+int get_mem_usage(mem_usage_t *usage);
+
+/** @brief register the stack of the calling thread as a grow-down region.
+ *         Faults between the lowest mapped page and hi - max_len map more
+ *         stack without a swexn handler, new_pages keeps off the region
+ *         and guard_len bytes below it. Pages already mapped right below
+ *         lo become part of the stack. The region goes away when the
+ *         thread vanishes, fork copies it and exec drops it.
+ *
+ *  @param hi the top of the stack, page aligned
+ *  @param lo the lowest mapped page of the stack
+ *  @param max_len the most the stack may span, 0 to unregister
+ *  @param guard_len the gap kept unmapped below the stack
+ *  @return 0 on success, a negative number on error
+ */
+int stack_region(void *hi, void *lo, int max_len, int guard_len);
+
+/** @brief start a program in a new child process, without copying the
+ *         calling process first like fork and exec do. The child can be
+ *         waited for like a forked one, and inherits the frame limit.
+ *
+ *  @param execname the program to run
+ *  @param argvec the NULL terminated arguments, argvec[0] is execname
+ *  @return the pid of the child on success, a negative number on error
+ */
+int spawn(char *execname, char **argvec);
+
+/** @brief freeze the calling (single threaded) process into a template.
+ *         The address space is shared copy-on-write with the template,
+ *         instances started by template_spawn return 0 from this call.
+ *
+ *  @return the template id (> 0) in the caller, 0 in an instance, a
+ *          negative number on error
+ */
+int template_freeze(void);
+
+/** @brief start a new child process from a template, it returns 0 from
+ *         the template_freeze call the template was made by
+ *
+ *  @param id the template id
+ *  @return the pid of the child on success, a negative number on error
+ */
+int template_spawn(int id);
+
+/** @brief free a template. Running instances are not affected. Only the
+ *         process that froze it may drop it
+ *
+ *  @param id the template id
+ *  @return 0 on success, a negative number on error
+ */
+int template_drop(int id);
+
+/** @brief register a submission/completion ring of the calling process,
+ *         replacing the one registered before. The ring has to stay
+ *         mapped and writable while registered. fork keeps it, exec
+ *         drops it.
+ *
+ *  @param ring the ring, RING_SIZE(entries) bytes, NULL to unregister
+ *  @param entries the slots in each queue, a power of two
+ *  @return 0 on success, a negative number on error
+ */
+int ring_setup(ring_t *ring, int entries);
+
+/** @brief run up to n submitted entries of the ring of the calling process
+ *         through their syscalls, posting a completion for each. Stops
+ *         early when the submission queue runs empty or the completion
+ *         queue full.
+ *
+ *  @param n the most entries to run
+ *  @return the entries run, a negative number on error
+ */
+int ring_enter(int n);
+
+/** @brief block the calling thread while the word at addr holds expected,
+ *         until futex_wake on the same word or the timeout. The check
+ *         and the blocking are atomic with respect to futex_wake.
+ *
+ *  @param addr the word, 4 byte aligned and writable
+ *  @param expected the value to sleep on
+ *  @param timeout the most ticks to sleep, 0 for no limit
+ *  @return 0 when woken, FUTEX_EAGAIN if the word did not hold expected,
+ *          FUTEX_ETIMEDOUT on timeout, another negative number on error
+ */
+int futex_wait(int *addr, int expected, int timeout);
+
+/** @brief wake up to n threads blocked in futex_wait on the word at addr,
+ *         the longest waiting first
+ *
+ *  @param addr the word
+ *  @param n the most threads to wake
+ *  @return the threads woken, a negative number on error
+ */
+int futex_wake(int *addr, int n);
+
+/** @brief copy the syscall statistics table of a process, or of the whole
+ *         system, into buf, one syscall_stat_t per SYS_ number
+ *
+ *  @param pid the process, 0 for the whole system
+ *  @param buf where to copy the table
+ *  @param n the most entries buf holds
+ *  @return the entries copied, a negative number on error or when the
+ *          kernel was built without the statistics
+ */
+int syscall_stats(int pid, syscall_stat_t *buf, int n);
+
+/** @brief choose when the console catches up with what is printed, or
+ *         where the serial port comes in
+ *
+ *  @param mode CONSOLE_MODE_SYNC to show every print before it returns,
+ *         CONSOLE_MODE_DEFERRED to show prints on the next timer tick, or
+ *         one of the CONSOLE_SERIAL_ modes
+ *  @return the mode of the same kind before, a negative number on error
+ *          (a CONSOLE_SERIAL_ mode other than off without a serial port)
+ */
+int console_mode(int mode);
+
+/** @brief move the calling process to a virtual terminal, the processes it
+ *         creates from then on start there as well
+ *
+ *  @param vt the terminal, 0 to NVTERMS - 1. Alt+F1 brings terminal 0 to
+ *         the screen, Alt+F2 terminal 1 and so on
+ *  @return the terminal before, a negative number on error
+ */
+int set_vterm(int vt);
+
+/** @brief copy a rectangle of cells to the terminal of the process, in one
+ *         call instead of a print per row
+ *
+ *  @param row the top row
+ *  @param col the left column
+ *  @param w the columns
+ *  @param h the rows
+ *  @param cells h rows of w cells, made with CONSOLE_CELL_OF
+ *  @return 0 on success, a negative number on error
+ */
+int blit_cells(int row, int col, int w, int h, const unsigned short *cells);
+
+/** @brief map the cells of the terminal of the process at CONSOLE_FB_ADDR,
+ *         or unmap them. Only one process owns a terminal at a time, the
+ *         others fail until it unmaps them, execs or exits
+ *
+ *  While mapped, CONSOLE_FB_ADDR holds CONSOLE_FB_ROWS rows of
+ *  CONSOLE_FB_COLS cells, top row first. What the owner writes there goes
+ *  to the screen on the next flush, while the terminal is in front.
+ *
+ *  @param map 1 to map, 0 to unmap
+ *  @return 0 on success, a negative number on error
+ */
+int console_map(int map);
+
+/** @brief wait until one of a set of events is ready, or for timeout ticks,
+ *         in one thread: a completed line on the terminal of the process
+ *         (POLL_CONSOLE, readline would not block), a child to collect
+ *         (POLL_CHILD, wait would not block), or get_ticks() reaching arg
+ *         (POLL_TIMER)
+ *
+ *  @param events the events, revents gets set to 1 for the ready ones
+ *         and 0 for the others
+ *  @param n the number of events, 0 to POLL_MAX_EVENTS
+ *  @param timeout the most ticks to wait, 0 to only look, negative for no
+ *         limit
+ *  @return the events ready, 0 on timeout, a negative number on error
+ */
+int poll(poll_event_t *events, int n, int timeout);
+
+/** @brief wait until everything printed before the call is on the
+ *         console. print returns once its bytes are queued, the console
+ *         catches up a little later
+ *
+ *  @return 0
+ */
+int print_flush(void);
+
+#endif /* !ASSEMBLER */
+
+#endif
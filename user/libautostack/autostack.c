@@ -1,12 +1,14 @@
 /** @file user/libautostack/autostack.c
  *
- *  @brief register exn handler (for autostack growth) for root thread
+ *  @brief set up autostack growth for root thread, by the kernel stack
+ *         region or else by an exn handler
  *
  *  @author HingOn Miu (hmiu@andrew.cmu.edu) 
  *  @author An Wu (anwu@andrew.cmu.edu)
  */
 
 #include <syscall.h>
+#include <syscall_ext.h>
 #include <ureg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,10 +18,13 @@
 #define PAGE_ALIGN_MASK 0xFFFFF000
 #define SINGLE_THREAD_EXN_STACK_SIZE 0x100        /* 0.25 KB */
 #define ESP_ALIGN_MASK  0xFFFFFFFC
+#define ROOT_STACK_MAX_LEN (16 * 1024 * 1024)     /* 16 MB */
+#define ROOT_STACK_GUARD_LEN PAGE_SIZE
 
 void *exn_stack_base;       /* indicate the start of exception stack */
 void *root_stack_hi;        /* indicate the high of root stack */
 void *root_stack_lo;        /* indicate the low of root stack */
+int autostack_in_kernel;    /* indicate the kernel grows the stacks */
 
 /*
  * @brief Allocate pages to the root thread stack up to the addr given.
@@ -92,7 +97,22 @@ void install_autostack(void *stack_high, void *stack_low)
     else {
         /* it must be single thread to begin with */
         root_stack_hi = stack_high;
-        
+
+        /* let the kernel grow the root stack on its faults. root_stack_lo
+         * is then the lowest the stack may ever reach, so thread stacks
+         * go below it
+         */
+        void *region_hi = (void *)(((unsigned int)stack_high + PAGE_SIZE - 1) 
+                                   & PAGE_ALIGN_MASK);
+        if (stack_region(region_hi, root_stack_lo, ROOT_STACK_MAX_LEN,
+                         ROOT_STACK_GUARD_LEN) == 0) {
+            autostack_in_kernel = 1;
+            root_stack_lo = region_hi - ROOT_STACK_MAX_LEN;
+            exn_stack_base = NULL;
+            return;
+        }
+
+        /* older kernel, grow it from the exception handler */
         exn_stack_base = _malloc(SINGLE_THREAD_EXN_STACK_SIZE) + 
                         SINGLE_THREAD_EXN_STACK_SIZE - 1;
 
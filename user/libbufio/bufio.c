@@ -0,0 +1,279 @@
+/** @file user/libbufio/bufio.c
+ *
+ *  @brief buffered print, a buffer per thread
+ *
+ *  The buffers are in a table hashed by thr_getid, which reads the thread
+ *  key off the stack without a syscall. A thread claims a free slot with a
+ *  cmpxchg the first time it writes and gives it back when it vanishes, so
+ *  threads never share a buffer and the mutex of a slot is only contended
+ *  when bufio_flush_all comes by, one call at a time rather than one char.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <bufio.h>
+#include <syscall.h>
+#include <thread.h>
+#include <mutex.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#define BUFIO_MASK (BUFIO_NBUFS - 1)
+
+/* the atomics of libthread (user/libthread/asm.h) */
+int cmpxchg(int *destination, int expected, int source);
+
+typedef struct bufio_buf {
+    int key;                /* the thread key of the owner, 0 if free */
+    int mode;               /* the buffering mode */
+    int len;                /* the bytes buffered */
+    mutex_t mp;             /* the owner against bufio_flush_all */
+    char buf[BUFIO_LEN];    /* the bytes */
+} bufio_buf_t;
+
+/* a free slot is empty and line buffered, so claiming needs no reset */
+static bufio_buf_t bufs[BUFIO_NBUFS] = {
+    [0 ... BUFIO_NBUFS - 1] = {
+        .key = 0,
+        .mode = BUFIO_LINE,
+        .len = 0,
+        .mp = { 1, MUTEX_UNLOCKED }
+    }
+};
+
+/** @brief find the buffer of the calling thread
+ *
+ *  @param claim whether to claim a free slot if it has none
+ *  @return the buffer, NULL if it has none (or all are taken)
+ */
+static bufio_buf_t *bufio_get(int claim)
+{
+    int key = thr_getid();
+    int i;
+    bufio_buf_t *b;
+
+    /* only the owner puts its key in a slot, so this can't race */
+    for (i = 0; i < BUFIO_NBUFS; i++) {
+        b = &bufs[(key + i) & BUFIO_MASK];
+        if (b->key == key)
+            return b;
+    }
+
+    if (!claim)
+        return NULL;
+
+    for (i = 0; i < BUFIO_NBUFS; i++) {
+        b = &bufs[(key + i) & BUFIO_MASK];
+        if (b->key == 0 && cmpxchg(&b->key, 0, key) == 0)
+            return b;
+    }
+
+    return NULL;
+}
+
+/** @brief print what is buffered. The mutex of the buffer held
+ *
+ *  @param b the buffer
+ *  @return 0 on success, -1 on error
+ */
+static int bufio_out(bufio_buf_t *b)
+{
+    int ret = 0;
+
+    if (b->len > 0)
+        ret = print(b->len, b->buf);
+    b->len = 0;
+
+    return ret;
+}
+
+/** @brief print the buffer if its mode wants it after s was added. The
+ *         mutex of the buffer held
+ *
+ *  @param b the buffer
+ *  @param s the bytes just added
+ *  @param len their length
+ *  @return 0 on success, -1 on error
+ */
+static int bufio_settle(bufio_buf_t *b, const char *s, int len)
+{
+    if (b->mode == BUFIO_UNBUFFERED || b->len == BUFIO_LEN ||
+        (b->mode == BUFIO_LINE && memchr(s, '\n', len) != NULL))
+        return bufio_out(b);
+
+    return 0;
+}
+
+int bufio_setmode(int mode)
+{
+    bufio_buf_t *b;
+    int old;
+
+    if (mode != BUFIO_UNBUFFERED && mode != BUFIO_LINE && mode != BUFIO_FULL)
+        return -1;
+
+    if ((b = bufio_get(1)) == NULL)
+        return BUFIO_UNBUFFERED;
+
+    mutex_lock(&b->mp);
+    old = b->mode;
+    b->mode = mode;
+    /* what was kept for the old mode would wait for the next write */
+    if (mode == BUFIO_UNBUFFERED)
+        bufio_out(b);
+    mutex_unlock(&b->mp);
+
+    return old;
+}
+
+int bufio_write(const char *buf, int len)
+{
+    bufio_buf_t *b;
+    int ret;
+
+    if (buf == NULL || len < 0)
+        return -1;
+
+    if (len == 0)
+        return 0;
+
+    /* no slot left, go straight to the console */
+    if ((b = bufio_get(1)) == NULL)
+        return print(len, (char *)buf);
+
+    mutex_lock(&b->mp);
+
+    if (len > BUFIO_LEN - b->len)
+        bufio_out(b);
+
+    if (len >= BUFIO_LEN) {
+        /* no point copying what fills the buffer on its own */
+        ret = print(len, (char *)buf);
+    }
+    else {
+        memcpy(b->buf + b->len, buf, len);
+        b->len += len;
+        ret = bufio_settle(b, buf, len);
+    }
+
+    mutex_unlock(&b->mp);
+
+    return ret;
+}
+
+int bufio_putchar(int c)
+{
+    char ch = (char)c;
+
+    bufio_write(&ch, 1);
+    return c;
+}
+
+int bufio_printf(const char *fmt, ...)
+{
+    va_list args;
+    bufio_buf_t *b;
+    char *s;
+    int n, room;
+
+    if ((b = bufio_get(1)) == NULL) {
+        char line[BUFIO_LEN];
+
+        va_start(args, fmt);
+        n = vsnprintf(line, BUFIO_LEN, fmt, args);
+        va_end(args);
+
+        if (n > BUFIO_LEN - 1)
+            n = BUFIO_LEN - 1;
+        print(n, line);
+        return n;
+    }
+
+    mutex_lock(&b->mp);
+
+    /* vsnprintf puts a '\0' after the chars, hence the room is one less */
+    s = b->buf + b->len;
+    room = BUFIO_LEN - b->len - 1;
+
+    va_start(args, fmt);
+    n = vsnprintf(s, room + 1, fmt, args);
+    va_end(args);
+
+    /* it may have been cut short, start over at the front of the buffer */
+    if (n >= room && b->len > 0) {
+        bufio_out(b);
+
+        s = b->buf;
+        room = BUFIO_LEN - 1;
+
+        va_start(args, fmt);
+        n = vsnprintf(s, room + 1, fmt, args);
+        va_end(args);
+    }
+
+    if (n < 0)
+        n = 0;
+    else if (n > room)
+        n = room;
+
+    b->len += n;
+    bufio_settle(b, s, n);
+
+    mutex_unlock(&b->mp);
+
+    return n;
+}
+
+int bufio_flush(void)
+{
+    bufio_buf_t *b;
+    int ret;
+
+    if ((b = bufio_get(0)) == NULL)
+        return 0;
+
+    mutex_lock(&b->mp);
+    ret = bufio_out(b);
+    mutex_unlock(&b->mp);
+
+    return ret;
+}
+
+void bufio_flush_all(void)
+{
+    bufio_buf_t *b;
+    int i;
+
+    for (i = 0; i < BUFIO_NBUFS; i++) {
+        b = &bufs[i];
+
+        /* a slot freed or claimed meanwhile is empty, the lock sorts out a
+         * write in progress
+         */
+        if (b->key == 0 || b->len == 0)
+            continue;
+
+        mutex_lock(&b->mp);
+        bufio_out(b);
+        mutex_unlock(&b->mp);
+    }
+}
+
+void bufio_release(void)
+{
+    bufio_buf_t *b;
+
+    if ((b = bufio_get(0)) == NULL)
+        return;
+
+    mutex_lock(&b->mp);
+    bufio_out(b);
+    b->mode = BUFIO_LINE;
+    mutex_unlock(&b->mp);
+
+    /* free only once it is empty and reset */
+    b->key = 0;
+}
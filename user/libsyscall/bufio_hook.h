@@ -0,0 +1,14 @@
+/* user/libsyscall/bufio_hook.h */
+/* Author: Hingon Miu (hmiu), An Wu (anwu) */
+
+/* Call fn if libbufio is linked in. The reference is weak, so a program
+ * that never buffers a print doesn't pull in libbufio and fn is 0. fn is
+ * a C function and leaves %esi, %edi, %ebx and %ebp alone.
+ */
+#define BUFIO_HOOK(fn)                                                       \
+    .weak   fn;                                                              \
+    MOVL    $fn, %eax;                                                       \
+    TESTL   %eax, %eax;                                                      \
+    JZ      1f;                                                              \
+    CALL    fn;                                                              \
+1:
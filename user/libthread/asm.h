@@ -22,3 +22,13 @@ int xchg(int *destination, int source);
  * @return Old destination value.
  */
 int xadd(int *destination, int source);
+
+/**
+ * @brief Atomic compare and exchange
+ *
+ * @param destination The address of the destination.
+ * @param expected The value destination has to hold.
+ * @param source The value to store if it does.
+ * @return Old destination value, expected if source got stored.
+ */
+int cmpxchg(int *destination, int expected, int source);
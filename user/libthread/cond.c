@@ -1,16 +1,21 @@
 /** @file cond.c
  *  @brief This file implements the condition variable.
  *
- *  @bug:  Fix the queue struct's data type to pointer address to data.
- *  @bug:  Fix atomically unlock mutex in wait
+ *         Waiters sleep in futex_wait on a sequence number that every
+ *         signal bumps. A signal between releasing the mutex and going to
+ *         sleep changes the number, so futex_wait returns at once instead
+ *         of losing the wakeup. Signals with nobody waiting make no
+ *         syscall.
  */
 /* Author: Hingon Miu (hmiu), An Wu (anwu) */
 
 #include <syscall.h>
+#include <syscall_ext.h>
 #include <cond.h>
 #include <stddef.h>
-#include <queue.h>
+#include <limits.h>
 #include <simics.h>
+#include "asm.h"
 
 /*
  * @brief This should initialize the condition variable pointed to
@@ -26,13 +31,9 @@ int cond_init(cond_t *cv)
         return -1;
     }
     /* init the fields */
+    cv->seq = 0;
+    cv->waiters = 0;
     cv->init = 1;
-    cv->wait_tids = queue_new();
-    if (cv->wait_tids == NULL) {
-        return -1;
-    }
-    /* init the lock */
-    mutex_init(&(cv->lock));
     return 0;
 }
 
@@ -51,14 +52,11 @@ void cond_destroy(cond_t *cv)
         return;
     }
 
-    else if (!queue_empty(cv->wait_tids)) {
+    else if (cv->waiters != 0) {
         /* there are blocked thread waiting */
         return;
     }
 
-    mutex_destroy(&(cv->lock));
-    queue_destroy(cv->wait_tids);
-
     cv->init = 0;
     return;
 }
@@ -75,19 +73,18 @@ void cond_destroy(cond_t *cv)
  */
 void cond_wait(cond_t *cv, mutex_t *mp)
 {
-    /* lock on cond queue and enqueue current thread */
-    mutex_lock(&(cv->lock));
-    int tid = gettid();
-    enqueue((void *)tid, cv->wait_tids);
-    mutex_unlock(&(cv->lock));
+    /* the signals so far, read while still holding mp */
+    int seq = cv->seq;
+    xadd(&(cv->waiters), 1);
 
     /* unlock the mutex mp */
-    mutex_unlock(mp);                       
-    
-    int zero = 0;
-    deschedule(&(zero));
+    mutex_unlock(mp);
+
+    /* sleeps unless a signal came after the read */
+    futex_wait(&(cv->seq), seq, 0);
+    xadd(&(cv->waiters), -1);
 
-    /* when deschedule returns, lock the mutex again */
+    /* when futex_wait returns, lock the mutex again */
     mutex_lock(mp);
 }
 
@@ -101,20 +98,10 @@ void cond_wait(cond_t *cv, mutex_t *mp)
  */
 void cond_signal(cond_t *cv)
 {
-    /* lock on cond queue and dequeue the top waiting thread */
-    mutex_lock(&(cv->lock));
-    void *tid_data = dequeue(cv->wait_tids);
-    mutex_unlock(&(cv->lock));
-    
-    if (tid_data == NULL) {
-        /* empty queue */
-        return;
-    }
+    xadd(&(cv->seq), 1);
 
-    int tid = (int)tid_data;
-    while (make_runnable(tid) < 0) {
-        // let it deschdule first
-        yield(tid);
+    if (cv->waiters > 0) {
+        futex_wake(&(cv->seq), 1);
     }
 }
 
@@ -128,16 +115,9 @@ void cond_signal(cond_t *cv)
  */
 void cond_broadcast(cond_t *cv)
 {
-    /* lock the cond queue and make every waiting tid runnable */
-    mutex_lock(&(cv->lock));
-    queue wait_q = cv->wait_tids;
-    
-    while (!queue_empty(wait_q)) {
-        int tid = (int) dequeue(wait_q);
-        while (make_runnable(tid) < 0) {
-            // let it deschedule first
-            yield(tid);
-        }
+    xadd(&(cv->seq), 1);
+
+    if (cv->waiters > 0) {
+        futex_wake(&(cv->seq), INT_MAX);
     }
-    mutex_unlock(&(cv->lock)); /* unlock the cond queue */
 }
@@ -7,10 +7,7 @@
  */
 
 #include <cond_private.h>
-#include <mutex_private.h>
-#include <queue.h>
 
 int cond_idle(cond_t *cv) {
-    return (cv->init == 1) && (queue_empty(cv->wait_tids)) && 
-        (mutex_idle(&(cv->lock)));
+    return (cv->init == 1) && (cv->waiters == 0);
 }
@@ -2,6 +2,11 @@
  *  @brief This file implements the mutex lock/unlock to ensure concurrent
  *         threads run without race conditions.
  *
+ *         An uncontended lock or unlock is a single atomic instruction.
+ *         A thread that finds the mutex taken marks it contended and
+ *         sleeps in futex_wait, and only the unlock of a contended mutex
+ *         calls futex_wake.
+ *
  *  @author Hingon Miu (hmiu) 
  *  @author An Wu (anwu) 
  */
@@ -10,6 +15,8 @@
 #include <mutex_type.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <syscall.h>
+#include <syscall_ext.h>
 #include "asm.h"
 #include <assert.h>
 
@@ -30,7 +37,7 @@ int mutex_init(mutex_t *mp)
 
     else {
         mp->init = 1;
-        mp->available = 1;
+        mp->state = MUTEX_UNLOCKED;
 
         return 0;
     }
@@ -56,16 +63,11 @@ void mutex_destroy(mutex_t *mp)
         panic("Attempt to destroy a unintialized mutex.");
     }
 
-    else if (!mp->available) {
+    else if (mp->state != MUTEX_UNLOCKED) {
         /* illegal to destroyed a mutex in use */
         panic("Attempt to destroy a locked mutex.");
     }
 
-    else if (mp->threads_count) {
-        /* other threads are trying to acquire this mutex */
-        panic("Attempt to destroy a mutex while others are acquiring it.");
-    }
-
     else {
         mp->init = 0;
 
@@ -95,11 +97,20 @@ void mutex_lock(mutex_t *mp)
     }
 
     else {
-        xadd(&mp->threads_count, 1);
+        int c;
 
-        while (!xchg(&mp->available, 0)) {
-            /* busy waiting for other threads to unlock */
-            continue;
+        /* fast path, nobody holds it */
+        if ((c = cmpxchg(&mp->state, MUTEX_UNLOCKED, MUTEX_LOCKED)) ==
+            MUTEX_UNLOCKED)
+            return;
+
+        /* mark it contended, so the holder wakes us when it unlocks */
+        if (c != MUTEX_CONTENDED)
+            c = xchg(&mp->state, MUTEX_CONTENDED);
+
+        while (c != MUTEX_UNLOCKED) {
+            futex_wait(&mp->state, MUTEX_CONTENDED, 0);
+            c = xchg(&mp->state, MUTEX_CONTENDED);
         }
 
         return;
@@ -127,8 +138,11 @@ void mutex_unlock(mutex_t *mp)
     }
 
     else {
-        xchg(&mp->available, 1);
-        xadd(&mp->threads_count, -1);
+        /* slow path only if someone went to sleep on it */
+        if (xadd(&mp->state, -1) != MUTEX_LOCKED) {
+            xchg(&mp->state, MUTEX_UNLOCKED);
+            futex_wake(&mp->state, 1);
+        }
 
         return;
     }
@@ -9,5 +9,5 @@
 #include <mutex_private.h>
 
 int mutex_idle(mutex_t *mp) {
-    return (mp->init == 1) && (mp->available == 1) && (mp->threads_count == 0);
+    return (mp->init == 1) && (mp->state == MUTEX_UNLOCKED);
 }
@@ -2,6 +2,10 @@
  *
  *  @brief functions for the read-write lock
  *
+ *         Writers are preferred: once a writer waits, new readers wait
+ *         behind it. Taking and releasing an uncontended lock only takes
+ *         and releases the futex based mutex, with no syscall.
+ *
  *  @author Hingon Miu (hmiu@andrew.cmu.edu)
  *  @author An Wu (anwu@andrew.cmu.edu)
  */
@@ -9,23 +13,8 @@
 #include <rwlock.h>
 
 #include <stddef.h>
-#include <thread.h>
 #include <mutex_private.h>
-#include <sem_private.h>
-
-/*
- * @brief This should compare the keys for splay tree.
- *
- * @param t1 The first key.
- * @param t2 The second key.
- *
- * @return 1 if t1 > t2, -1 if t1 < t2, 0 if t1 == t2.
- */
-int thr_id_comp(int t1, int t2) {
-    if (t1 > t2) return 1;
-    else if (t1 < t2) return -1;
-    else return 0;
-}
+#include <cond_private.h>
 
 /*
  * @brief This should initialize the lock pointed to
@@ -41,11 +30,10 @@ int rwlock_init( rwlock_t *rwlock )
         return -1;
 
     rwlock->read_count = 0;
-    sem_init(&(rwlock->rw_mutex), 1);
-    sem_init(&(rwlock->enter_mutex), 1);
-    sem_init(&(rwlock->mutex), 1);
-    rwlock->rw_tids = st_new(thr_id_comp);
-    mutex_init(&(rwlock->st_mp));
+    rwlock->writer = 0;
+    rwlock->write_waiting = 0;
+    mutex_init(&(rwlock->mp));
+    cond_init(&(rwlock->cv));
     rwlock->init = 1;
     return 0;
 }
@@ -62,38 +50,29 @@ int rwlock_init( rwlock_t *rwlock )
  */
 void rwlock_lock( rwlock_t *rwlock, int type ) 
 {
-    if (type == RWLOCK_READ) {
-        /* make sure writer is not waiting */
-        int empty;
-        do {
-            sem_wait(&(rwlock->enter_mutex));
-            sem_signal(&(rwlock->enter_mutex));
-
-            mutex_lock(&(rwlock->st_mp));
-            empty = st_empty(rwlock->rw_tids);
-            mutex_unlock(&(rwlock->st_mp));
+    mutex_lock(&(rwlock->mp));
 
-        } while (!empty);
+    if (type == RWLOCK_READ) {
+        /* make sure writer is not holding or waiting */
+        while (rwlock->writer || rwlock->write_waiting)
+            cond_wait(&(rwlock->cv), &(rwlock->mp));
 
-        sem_wait(&(rwlock->mutex));
         rwlock->read_count++;
-        if (rwlock->read_count == 1)
-            sem_wait(&(rwlock->rw_mutex));
-        sem_signal(&(rwlock->mutex));
 
         /* reading */
     }
     else {
+        rwlock->write_waiting++;
+        while (rwlock->writer || rwlock->read_count)
+            cond_wait(&(rwlock->cv), &(rwlock->mp));
+        rwlock->write_waiting--;
 
-        mutex_lock(&(rwlock->st_mp));
-        st_insert(rwlock->rw_tids, thr_getid(), (void *)1);
-        mutex_unlock(&(rwlock->st_mp));
-        
-        sem_wait(&(rwlock->enter_mutex));
-        sem_wait(&(rwlock->rw_mutex));
+        rwlock->writer = 1;
 
         /* writing */
     }
+
+    mutex_unlock(&(rwlock->mp));
 }
 
 /*
@@ -107,24 +86,18 @@ void rwlock_lock( rwlock_t *rwlock, int type )
  */
 void rwlock_unlock( rwlock_t *rwlock )
 {
+    mutex_lock(&(rwlock->mp));
+
+    if (rwlock->writer)
+        rwlock->writer = 0;
+    else
+        rwlock->read_count--;
 
-        /* reader */
-        mutex_lock(&(rwlock->st_mp));
-        int is_writer = (int) st_delete(rwlock->rw_tids, thr_getid());
-        mutex_unlock(&(rwlock->st_mp));
-
-        if (is_writer) {
-            sem_signal(&(rwlock->rw_mutex));
-            sem_signal(&(rwlock->enter_mutex));
-        }
-        else {
-            sem_wait(&(rwlock->mutex));
-            rwlock->read_count--;
-            if (rwlock->read_count == 0)
-                sem_signal(&(rwlock->rw_mutex));
-            sem_signal(&(rwlock->mutex));
-        }
+    /* the lock is free, let the waiters sort it out */
+    if (rwlock->read_count == 0)
+        cond_broadcast(&(rwlock->cv));
 
+    mutex_unlock(&(rwlock->mp));
 }
 
 /*
@@ -137,14 +110,11 @@ void rwlock_unlock( rwlock_t *rwlock )
  */
 void rwlock_destroy( rwlock_t *rwlock )
 {
-    if (rwlock->init && sem_idle(&(rwlock->enter_mutex)) && 
-        sem_idle(&(rwlock->rw_mutex)) &&
-        sem_idle(&(rwlock->mutex)) && mutex_idle(&(rwlock->st_mp))) {
-        sem_destroy(&(rwlock->enter_mutex));
-        sem_destroy(&(rwlock->rw_mutex));
-        sem_destroy(&(rwlock->mutex));
-        mutex_destroy(&(rwlock->st_mp));
-        st_destroy(rwlock->rw_tids);
+    if (rwlock->init && !rwlock->writer && rwlock->read_count == 0 &&
+        rwlock->write_waiting == 0 && mutex_idle(&(rwlock->mp)) &&
+        cond_idle(&(rwlock->cv))) {
+        cond_destroy(&(rwlock->cv));
+        mutex_destroy(&(rwlock->mp));
         rwlock->init = 0;
     }
 
@@ -160,17 +130,13 @@ void rwlock_destroy( rwlock_t *rwlock )
  * @return Void.
  */
 void rwlock_downgrade( rwlock_t *rwlock) {
-    mutex_lock(&(rwlock->st_mp));
-    st_delete(rwlock->rw_tids, thr_getid());
-    mutex_unlock(&(rwlock->st_mp));
+    mutex_lock(&(rwlock->mp));
 
-    sem_signal(&(rwlock->enter_mutex));
-    sem_signal(&(rwlock->rw_mutex));
+    rwlock->writer = 0;
+    rwlock->read_count = 1;
 
-    sem_wait(&(rwlock->mutex));
-    rwlock->read_count++;
-    if (rwlock->read_count == 1)
-        sem_wait(&(rwlock->rw_mutex));
-    sem_signal(&(rwlock->mutex));
+    /* the waiting readers may come in, unless a writer waits too */
+    cond_broadcast(&(rwlock->cv));
 
+    mutex_unlock(&(rwlock->mp));
 }
@@ -1,13 +1,20 @@
 /** @file sem.c
  *
  *  @brief functions for semaphore
+ *
+ *         The count never goes below 0. A wait that finds it positive
+ *         takes one with a compare and exchange, one that finds it 0
+ *         sleeps in futex_wait on it. A signal only calls futex_wake
+ *         when somebody is waiting.
  *  @author Hingon Miu (hmiu@andrew.cmu.edu)
  *  @author An Wu (anwu@andrew.cmu.edu)
  */
 
 #include <stddef.h>
-#include <mutex_private.h>
-#include <cond_private.h>
+#include <syscall.h>
+#include <syscall_ext.h>
+#include <sem_private.h>
+#include "asm.h"
 
 #include <sem.h>
 
@@ -26,9 +33,12 @@ int sem_init(sem_t *sem, int count)
         return -1;
     }
 
+    if (count < 0) {
+        return -1;
+    }
+
     sem->count = count;
-    cond_init(&(sem->cv));
-    mutex_init(&(sem->mp));
+    sem->waiters = 0;
     sem->init = 1;
     return 0;
 }
@@ -45,12 +55,26 @@ int sem_init(sem_t *sem, int count)
  */
 void sem_wait(sem_t *sem)
 {
-    mutex_lock(&(sem->mp));
-    sem->count--;
-    if (sem->count < 0) {
-        cond_wait(&(sem->cv), &(sem->mp));
+    int c = sem->count;
+
+    while (1) {
+        if (c > 0) {
+            int old = cmpxchg(&(sem->count), c, c - 1);
+            if (old == c) {
+                return;
+            }
+            /* lost the race, try again with what is there now */
+            c = old;
+            continue;
+        }
+
+        /* sleeps unless a signal came after the read */
+        xadd(&(sem->waiters), 1);
+        futex_wait(&(sem->count), c, 0);
+        xadd(&(sem->waiters), -1);
+
+        c = sem->count;
     }
-    mutex_unlock(&(sem->mp));
 }
 
 /*
@@ -63,13 +87,11 @@ void sem_wait(sem_t *sem)
  */
 void sem_signal(sem_t *sem) 
 {
-    mutex_lock(&(sem->mp));
-    sem->count++;
-    if (sem->count <= 0) {
-        cond_signal(&(sem->cv));
-    }
-    mutex_unlock(&(sem->mp));
+    xadd(&(sem->count), 1);
 
+    if (sem->waiters > 0) {
+        futex_wake(&(sem->count), 1);
+    }
 }
 
 /*
@@ -82,9 +104,7 @@ void sem_signal(sem_t *sem)
  */
 void sem_destroy(sem_t *sem) 
 {
-    if (mutex_idle(&(sem->mp)) && (cond_idle(&(sem->cv)))) {
+    if (sem_idle(sem)) {
         sem->init = 0;
-        cond_destroy(&(sem->cv));
-        mutex_destroy(&(sem->mp));
     }
 }
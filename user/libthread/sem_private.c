@@ -7,9 +7,7 @@
  */
 
 #include <sem_private.h>
-#include <cond_private.h>
-#include <mutex_private.h>
 
 int sem_idle(sem_t *sem) {
-    return (sem->init == 1 && cond_idle(&(sem->cv)) && mutex_idle(&(sem->mp)));
+    return (sem->init == 1 && sem->waiters == 0);
 }
@@ -84,6 +84,10 @@ void exception_handler(void *arg, ureg_t *ureg)
     cond_signal(&(thr_info->status_cv));
     mutex_unlock(&(thr_info->status_mp));
     
+    /* give up the stack region before the stack can be reused */
+    if (autostack_in_kernel)
+        stack_region(NULL, NULL, 0, 0);
+
     /* store the stack_base for later reuse */
     mutex_lock(&queue_mutex);
     enqueue(stack_base, exited_thr_queue);
@@ -110,8 +114,16 @@ void *alloc_child_stack()
             return NULL;
         }
 
+        /* the kernel grows the stack, the child only starts on its top */
+        /* page (see setup_and_run_child) */
         void *child_stack_lo = exn_stack_lo - thr_stack_size;
-        if (new_pages(child_stack_lo, thr_stack_size) < 0) {
+        if (autostack_in_kernel) {
+            if (new_pages(exn_stack_lo - PAGE_SIZE, PAGE_SIZE) < 0) {
+                /* no available page left */
+                return NULL;
+            }
+        }
+        else if (new_pages(child_stack_lo, thr_stack_size) < 0) {
             /* no available page left */
             return NULL;
         }
@@ -134,6 +146,20 @@ int generate_thr_key()
     return new_key;
 }
 
+void register_child_stack(void *stack_base)
+{
+    void *stack_hi = (void *)(((unsigned long)stack_base + PAGE_SIZE - 1) &
+                              PAGE_ALIGN_MASK);
+    void *stack_lo = stack_hi - PAGE_SIZE;
+
+    /* the thread that had this stack before gave up its region before */
+    /* putting the stack on the queue (see thr_exit), so this only fails */
+    /* when the kernel is out of memory, and the child has nothing to run */
+    /* on past its top page */
+    if (stack_region(stack_hi, stack_lo, thr_stack_size, FAULT_SIZE) != 0)
+        panic("thread %d can't register its stack", thr_getid());
+}
+
 void setup_and_run_child(int thr_key) {
     mutex_lock(&st_mutex);
     thread_info child_thr_info = st_lookup(thr_splay_tree, thr_key);
@@ -142,6 +168,9 @@ void setup_and_run_child(int thr_key) {
     if (child_thr_info == NULL)
         thr_exit(NULL);    /* can't find thr info */
     
+    if (autostack_in_kernel)
+        register_child_stack(child_thr_info->stack_base);
+
     /* register handler for new thread in multi-threading mode */
     swexn(child_thr_info->stack_base + EXN_STACK_SIZE, &exception_handler, 
             NULL, NULL);
@@ -14,11 +14,13 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <syscall.h>
+#include <syscall_ext.h>
 #include <mutex.h>
 #include <thread.h>
 #include <cond.h>
 #include <malloc.h>
 #include <simics.h>
+#include <assert.h>
 
 #include <queue.h>
 #include <autostack_private.h>
@@ -108,6 +110,14 @@ void *alloc_child_stack();
  */
 int generate_thr_key();
 
+/*
+ * @brief Register the stack of the calling child thread with the kernel,
+ *        so it grows on faults. Panics if that fails.
+ *
+ * @param stack_base The child thread stack base pointer.
+ */
+void register_child_stack(void *stack_base);
+
 /** @brief Setup the child after stack change and run its task
   *
   * @param thr_key the child's thr_key
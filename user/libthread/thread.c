@@ -72,7 +72,8 @@ int thr_init(unsigned int size)
 int thr_create(void *(*func)(void *), void *args)
 {
     if (xchg(&before_thr_create, 0)) {
-        /* root stack stops auto-growth */
+        /* root stack stops auto-growth, unless the kernel grows it, then */
+        /* root_stack_lo is already its limit */
         /* free the heap allocated exception stack */
         free(exn_stack_base);
         exn_stack_base = NULL;
@@ -206,6 +207,11 @@ void thr_exit(void *status)
     cond_signal(&(thr_info->status_cv));
     mutex_unlock(&(thr_info->status_mp));
     
+    /* give up the stack region before the stack can be reused, so the */
+    /* next thread on it can register its own */
+    if (autostack_in_kernel)
+        stack_region(NULL, NULL, 0, 0);
+
     /* store the stack_base for later reuse */
     mutex_lock(&queue_mutex);
     enqueue(stack_base, exited_thr_queue);
@@ -0,0 +1,84 @@
+/** @file user/progs/ansi_bench.c
+ *
+ *  @brief compare redrawing a screen region with separate syscalls and
+ *         with one print of ANSI escape sequences
+ *
+ *  Each frame draws RUNS styled runs of text at different places: once as
+ *  set_cursor_pos, set_term_color and print for every run, once as a
+ *  single print with ESC [ row ; col H and ESC [ ... m in front of every
+ *  run. Reports the TSC cycles per frame of each.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <stdio.h>
+#include <string.h>
+
+/* the frames drawn each way */
+#define ROUNDS 256
+
+/* the styled runs of a frame */
+#define RUNS 20
+
+/* the text of a run */
+#define RUN_TEXT "0123456789abcdef"
+
+/* the VGA color and the ANSI colors of a run */
+#define RUN_COLOR(i) (((i) % 7) + 1)
+#define RUN_ANSI(i) (30 + ((i) % 7) + 1)
+
+static char frame[RUNS * 32];
+
+/** @brief read the time stamp counter
+ *
+ *  @return the cycles since reset
+ */
+static unsigned long long rdtsc(void)
+{
+    unsigned long long tsc;
+
+    asm volatile ("rdtsc" : "=A" (tsc));
+    return tsc;
+}
+
+int main()
+{
+    unsigned long long start, calls_cycles, ansi_cycles;
+    int i, r, len = 0;
+
+    /* the same frame as escape sequences. The VGA and ANSI colors are not
+     * the same colors, only the same number of changes
+     */
+    for (i = 0; i < RUNS; i++)
+        len += sprintf(frame + len, "\033[%d;%dH\033[%dm%s", i + 1,
+                       (i * 3) % 60 + 1, RUN_ANSI(i), RUN_TEXT);
+    len += sprintf(frame + len, "\033[0m");
+
+    start = rdtsc();
+    for (r = 0; r < ROUNDS; r++) {
+        for (i = 0; i < RUNS; i++) {
+            set_cursor_pos(i, (i * 3) % 60);
+            set_term_color(RUN_COLOR(i));
+            print(strlen(RUN_TEXT), RUN_TEXT);
+        }
+    }
+    calls_cycles = rdtsc() - start;
+
+    start = rdtsc();
+    for (r = 0; r < ROUNDS; r++)
+        print(len, frame);
+    ansi_cycles = rdtsc() - start;
+
+    /* clean up the noise */
+    print(8, "\033[0m\033[2J");
+    set_cursor_pos(0, 0);
+
+    printf("ansi_bench: %d frames of %d runs\n", ROUNDS, RUNS);
+    printf("ansi_bench: syscalls %u, escape sequences %u cycles per frame\n",
+           (unsigned)(calls_cycles / ROUNDS),
+           (unsigned)(ansi_cycles / ROUNDS));
+
+    return 0;
+}
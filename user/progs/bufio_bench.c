@@ -0,0 +1,100 @@
+/** @file user/progs/bufio_bench.c
+ *
+ *  @brief measure buffered print against a print per char
+ *
+ *  Writes short lines one char at a time, with a print each, with
+ *  bufio_putchar line buffered and fully buffered, and with a bufio_printf
+ *  per line, and reports the TSC cycles per char of each. The report
+ *  itself is buffered too and only goes out on the flush before exit.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <stdio.h>
+#include <bufio.h>
+
+/* the number of lines of each kind */
+#define ROUNDS 64
+
+/* the length of a line, newline included */
+#define LINE_LEN 32
+
+/** @brief read the time stamp counter
+ *
+ *  @return the cycles since reset
+ */
+static unsigned long long rdtsc(void)
+{
+    unsigned long long tsc;
+
+    asm volatile ("rdtsc" : "=A" (tsc));
+    return tsc;
+}
+
+/** @brief write ROUNDS lines, a char at a time
+ *
+ *  @param buffered whether to go through bufio
+ *  @return the cycles per char until they are all on the console
+ */
+static unsigned int time_chars(int buffered)
+{
+    unsigned long long start = rdtsc();
+    char c;
+    int i, j;
+
+    for (i = 0; i < ROUNDS; i++) {
+        for (j = 0; j < LINE_LEN; j++) {
+            c = (j == LINE_LEN - 1) ? '\n' : 'a' + j % 26;
+            if (buffered)
+                bufio_putchar(c);
+            else
+                print(1, &c);
+        }
+    }
+
+    bufio_flush();
+    print_flush();
+
+    return (rdtsc() - start) / (ROUNDS * LINE_LEN);
+}
+
+/** @brief write ROUNDS lines, a bufio_printf each
+ *
+ *  @return the cycles per char until they are all on the console
+ */
+static unsigned int time_printf(void)
+{
+    unsigned long long start = rdtsc();
+    int i;
+
+    for (i = 0; i < ROUNDS; i++)
+        bufio_printf("line %4d of %4d, %12s\n", i, ROUNDS, "bufio");
+
+    bufio_flush();
+    print_flush();
+
+    return (rdtsc() - start) / (ROUNDS * LINE_LEN);
+}
+
+int main()
+{
+    unsigned int raw, line, full, fmt;
+
+    raw = time_chars(0);
+
+    bufio_setmode(BUFIO_LINE);
+    line = time_chars(1);
+    fmt = time_printf();
+
+    bufio_setmode(BUFIO_FULL);
+    full = time_chars(1);
+
+    bufio_printf("bufio_bench: %d lines of %d chars\n", ROUNDS, LINE_LEN);
+    bufio_printf("bufio_bench: print per char %u, line buffered %u, fully "
+                 "buffered %u, bufio_printf per line %u cycles per char\n",
+                 raw, line, full, fmt);
+
+    return 0;
+}
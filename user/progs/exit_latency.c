@@ -0,0 +1,65 @@
+/** @file user/progs/exit_latency.c
+ *
+ *  @brief measure the time from the exit of a big process to the return
+ *         of its parent's wait
+ *
+ *  The child maps (and so touches, new_pages zeroes the pages) 128 MB,
+ *  records the tick it exits at as its exit status and vanishes. The
+ *  parent reports how many ticks later wait returned.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <stdio.h>
+
+/* the size of the exiting process */
+#define BIG_LEN (128 * 1024 * 1024)
+
+/* somewhere above the program image */
+#define BIG_BASE ((void *)0x10000000)
+
+/* the number of runs */
+#define ROUNDS 5
+
+int main()
+{
+    int i, pid, status;
+    unsigned int now;
+    unsigned int total = 0;
+
+    for (i = 0; i < ROUNDS; i++) {
+        if ((pid = fork()) < 0) {
+            printf("exit_latency: fork failed\n");
+            return -1;
+        }
+
+        if (pid == 0) {
+            if (new_pages(BIG_BASE, BIG_LEN) < 0) {
+                set_status(-1);
+                vanish();
+            }
+            set_status(get_ticks());
+            vanish();
+        }
+
+        if (wait(&status) != pid || status < 0) {
+            printf("exit_latency: child could not map %d MB\n", 
+                   BIG_LEN >> 20);
+            return -1;
+        }
+
+        now = get_ticks();
+        printf("exit_latency: round %d, %u ticks from exit to wait\n", 
+               i, now - (unsigned int)status);
+        total += now - (unsigned int)status;
+
+        /* let the reaper catch up before the next round */
+        sleep(10);
+    }
+
+    printf("exit_latency: %u ticks on average\n", total / ROUNDS);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/** @file user/progs/fb_bench.c
+ *
+ *  @brief compare three ways of redrawing a dashboard rectangle
+ *
+ *  Each frame redraws ROWS rows of COLS characters: once with a
+ *  set_cursor_pos and a print per row, once with a single blit_cells, and
+ *  once by writing the cells at CONSOLE_FB_ADDR after console_map, with
+ *  no syscall at all. Reports the TSC cycles per frame of each.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <syscall_ext.h>
+#include <stdio.h>
+
+/* the frames drawn each way */
+#define ROUNDS 256
+
+/* the rectangle */
+#define ROWS 20
+#define COLS 60
+
+/* the color of the dashboard */
+#define DASH_COLOR 0x1f
+
+static char text[ROWS][COLS];
+static unsigned short cells[ROWS * COLS];
+
+/** @brief read the time stamp counter
+ *
+ *  @return the cycles since reset
+ */
+static unsigned long long rdtsc(void)
+{
+    unsigned long long tsc;
+
+    asm volatile ("rdtsc" : "=A" (tsc));
+    return tsc;
+}
+
+int main()
+{
+    unsigned long long start, print_cycles, blit_cycles, map_cycles = 0;
+    volatile unsigned short *fb = (unsigned short *)CONSOLE_FB_ADDR;
+    int r, i, j, mapped;
+
+    for (i = 0; i < ROWS; i++) {
+        for (j = 0; j < COLS; j++) {
+            text[i][j] = 'a' + (i + j) % 26;
+            cells[i * COLS + j] = CONSOLE_CELL_OF(text[i][j], DASH_COLOR);
+        }
+    }
+
+    start = rdtsc();
+    for (r = 0; r < ROUNDS; r++) {
+        for (i = 0; i < ROWS; i++) {
+            set_cursor_pos(i, 0);
+            print(COLS, text[i]);
+        }
+    }
+    print_cycles = rdtsc() - start;
+
+    start = rdtsc();
+    for (r = 0; r < ROUNDS; r++)
+        blit_cells(0, 0, COLS, ROWS, cells);
+    blit_cycles = rdtsc() - start;
+
+    if ((mapped = (console_map(1) == 0))) {
+        start = rdtsc();
+        for (r = 0; r < ROUNDS; r++) {
+            for (i = 0; i < ROWS; i++) {
+                for (j = 0; j < COLS; j++)
+                    fb[i * CONSOLE_FB_COLS + j] = cells[i * COLS + j];
+            }
+        }
+        map_cycles = rdtsc() - start;
+
+        console_map(0);
+    }
+
+    /* clean up the noise */
+    print(8, "\033[0m\033[2J");
+    set_cursor_pos(0, 0);
+
+    printf("fb_bench: %d frames of %dx%d\n", ROUNDS, COLS, ROWS);
+    printf("fb_bench: print %u, blit_cells %u cycles per frame\n",
+           (unsigned)(print_cycles / ROUNDS),
+           (unsigned)(blit_cycles / ROUNDS));
+    if (mapped)
+        printf("fb_bench: mapped %u cycles per frame\n",
+               (unsigned)(map_cycles / ROUNDS));
+    else
+        printf("fb_bench: terminal owned by another process\n");
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/** @file user/progs/pollwatch.c
+ *
+ *  @brief watch the keyboard, a child and a timer from a single thread
+ *
+ *  pollwatch [program args...] spawns the program, if there is one, then
+ *  waits in poll for a line typed on its terminal, the child to exit and a
+ *  heartbeat every HEARTBEAT ticks, and says which one happened. Typing
+ *  "quit" ends it. Without poll this takes a thread blocked in readline,
+ *  one in wait and one in sleep.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <syscall_ext.h>
+#include <stdio.h>
+#include <string.h>
+
+/* the ticks between heartbeats */
+#define HEARTBEAT 500
+
+/* the longest line read */
+#define LINE_LEN 128
+
+int main(int argc, char **argv)
+{
+    poll_event_t ev[3];
+    char line[LINE_LEN];
+    unsigned int next_beat;
+    int children = 0;
+    int n, len, pid, status;
+
+    if (argc > 1) {
+        if ((pid = spawn(argv[1], &argv[1])) < 0) {
+            printf("pollwatch: can't spawn %s\n", argv[1]);
+            return -1;
+        }
+        printf("pollwatch: spawned %s as %d\n", argv[1], pid);
+        children = 1;
+    }
+
+    next_beat = get_ticks() + HEARTBEAT;
+
+    while (1) {
+        ev[0].type = POLL_CONSOLE;
+        ev[1].type = POLL_TIMER;
+        ev[1].arg = next_beat;
+        ev[2].type = POLL_CHILD;
+        n = children ? 3 : 2;
+
+        if (poll(ev, n, -1) < 0) {
+            printf("pollwatch: poll failed\n");
+            return -1;
+        }
+
+        if (ev[0].revents) {
+            len = readline(LINE_LEN - 1, line);
+            line[len] = '\0';
+            if (len > 0 && line[len - 1] == '\n')
+                line[len - 1] = '\0';
+
+            if (strcmp(line, "quit") == 0)
+                break;
+            printf("pollwatch: line \"%s\"\n", line);
+        }
+
+        if (ev[1].revents) {
+            printf("pollwatch: heartbeat at tick %u\n", get_ticks());
+            next_beat += HEARTBEAT;
+        }
+
+        if (children && ev[2].revents) {
+            if ((pid = wait(&status)) < 0)
+                children = 0;
+            else
+                printf("pollwatch: child %d exited with %d\n", pid, status);
+        }
+    }
+
+    return 0;
+}
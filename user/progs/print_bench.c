@@ -0,0 +1,131 @@
+/** @file user/progs/print_bench.c
+ *
+ *  @brief measure the console output throughput of print
+ *
+ *  Prints 4 KB buffers of plain text (no newline, so the console wraps
+ *  and scrolls on its own), of short lines, and of single characters one
+ *  print at a time, and reports the TSC cycles per byte of each, once with
+ *  the console flushed on every print (CONSOLE_MODE_SYNC) and once with it
+ *  flushed on the timer tick (CONSOLE_MODE_DEFERRED). print returns once
+ *  its bytes are queued for the console worker, so the cycles until the
+ *  prints return and until print_flush says they are drawn are both
+ *  reported. The screen gets cleared of the noise at the end.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <syscall_ext.h>
+#include <stdio.h>
+
+/* the size of one print */
+#define BUF_LEN 4096
+
+/* the number of prints of each kind */
+#define ROUNDS 64
+
+/* the length of a short line, newline included */
+#define LINE_LEN 32
+
+/* the console modes to measure */
+#define NMODES 2
+
+static char text[BUF_LEN];
+static char lines[BUF_LEN];
+
+static const char *mode_names[NMODES] = {
+    [CONSOLE_MODE_SYNC] = "sync",
+    [CONSOLE_MODE_DEFERRED] = "deferred",
+};
+
+/** @brief read the time stamp counter
+ *
+ *  @return the cycles since reset
+ */
+static unsigned long long rdtsc(void)
+{
+    unsigned long long tsc;
+
+    asm volatile ("rdtsc" : "=A" (tsc));
+    return tsc;
+}
+
+/** @brief print a buffer ROUNDS times
+ *
+ *  @param buf the buffer
+ *  @param len its length
+ *  @param chunk the bytes per print
+ *  @param drawn where to put the cycles until it is all on the console
+ *  @return the cycles until the last print returned
+ */
+static unsigned long long time_prints(char *buf, int len, int chunk,
+                                      unsigned long long *drawn)
+{
+    unsigned long long start = rdtsc();
+    unsigned long long returned;
+    int i, off;
+
+    for (i = 0; i < ROUNDS; i++) {
+        for (off = 0; off < len; off += chunk)
+            print(chunk, buf + off);
+    }
+
+    returned = rdtsc() - start;
+    print_flush();
+    *drawn = rdtsc() - start;
+
+    return returned;
+}
+
+int main()
+{
+    unsigned long long text_cycles[NMODES], line_cycles[NMODES];
+    unsigned long long byte_cycles[NMODES];
+    unsigned long long text_drawn[NMODES], line_drawn[NMODES];
+    unsigned long long byte_drawn[NMODES];
+    int i, mode, old_mode;
+
+    for (i = 0; i < BUF_LEN; i++) {
+        text[i] = 'a' + i % 26;
+        lines[i] = (i % LINE_LEN == LINE_LEN - 1) ? '\n' : 'a' + i % 26;
+    }
+
+    if ((old_mode = console_mode(CONSOLE_MODE_SYNC)) < 0) {
+        printf("print_bench: no console modes\n");
+        return -1;
+    }
+
+    for (mode = 0; mode < NMODES; mode++) {
+        console_mode(mode);
+        text_cycles[mode] = time_prints(text, BUF_LEN, BUF_LEN,
+                                        &text_drawn[mode]);
+        line_cycles[mode] = time_prints(lines, BUF_LEN, BUF_LEN,
+                                        &line_drawn[mode]);
+        byte_cycles[mode] = time_prints(text, BUF_LEN / 16, 1,
+                                        &byte_drawn[mode]);
+    }
+
+    console_mode(old_mode);
+
+    set_cursor_pos(0, 0);
+    for (i = 0; i < 25; i++)
+        printf("%79s\n", "");
+    set_cursor_pos(0, 0);
+
+    printf("print_bench: %d prints of %d bytes each way\n", ROUNDS, BUF_LEN);
+    for (mode = 0; mode < NMODES; mode++) {
+        printf("print_bench: %s: text %u (%u drawn), lines %u (%u drawn) "
+               "cycles per byte\n", mode_names[mode],
+               (unsigned)(text_cycles[mode] / (ROUNDS * BUF_LEN)),
+               (unsigned)(text_drawn[mode] / (ROUNDS * BUF_LEN)),
+               (unsigned)(line_cycles[mode] / (ROUNDS * BUF_LEN)),
+               (unsigned)(line_drawn[mode] / (ROUNDS * BUF_LEN)));
+        printf("print_bench: %s: single bytes %u (%u drawn) cycles per "
+               "print\n", mode_names[mode],
+               (unsigned)(byte_cycles[mode] / (ROUNDS * (BUF_LEN / 16))),
+               (unsigned)(byte_drawn[mode] / (ROUNDS * (BUF_LEN / 16))));
+    }
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/** @file user/progs/ring_bench.c
+ *
+ *  @brief compare plain syscalls with batches through a ring
+ *
+ *  Prints a single character ROUNDS times, then maps and unmaps a page
+ *  ROUNDS times, first one syscall each, then through a ring of
+ *  RING_ENTRIES slots entered once per full batch.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <syscall_ext.h>
+#include <stdio.h>
+
+/* the number of calls (or pairs) each way */
+#define ROUNDS 10000
+
+/* the slots in each queue of the ring */
+#define RING_ENTRIES 256
+
+/* where the ring goes, and the page mapped and unmapped */
+#define RING_BASE ((void *)0x10000000)
+#define PAGE_BASE ((void *)0x20000000)
+
+static ring_t *ring = RING_BASE;
+
+/* the argument packets, the same for every call */
+static char dot = '.';
+static struct { int len; char *buf; } print_args = { 1, &dot };
+static struct { void *base; int len; } new_pages_args = { PAGE_BASE, 
+                                                          PAGE_SIZE };
+
+/** @brief queue a submission, running the ring first if it is full
+ *
+ *  @param op the SYS_ number
+ *  @param arg the argument
+ *  @return 0 on success, -1 on error
+ */
+static int submit(int op, int arg)
+{
+    ring_sqe_t *sqe;
+
+    if (ring->sq_tail - ring->sq_head == RING_ENTRIES) {
+        if (ring_enter(RING_ENTRIES) < 0)
+            return -1;
+
+        /* nobody looks at the results but the errors */
+        while (ring->cq_head != ring->cq_tail) {
+            if (RING_CQES(ring, RING_ENTRIES)[ring->cq_head &
+                                              (RING_ENTRIES - 1)].res < 0)
+                return -1;
+            ring->cq_head++;
+        }
+    }
+
+    sqe = &(RING_SQES(ring)[ring->sq_tail & (RING_ENTRIES - 1)]);
+    sqe->op = op;
+    sqe->arg = arg;
+    sqe->user_data = ring->sq_tail;
+    ring->sq_tail++;
+    return 0;
+}
+
+/** @brief run what is left in the ring
+ *
+ *  @return 0 on success, -1 on error
+ */
+static int drain(void)
+{
+    while (ring->sq_head != ring->sq_tail) {
+        if (ring_enter(RING_ENTRIES) < 0)
+            return -1;
+
+        while (ring->cq_head != ring->cq_tail) {
+            if (RING_CQES(ring, RING_ENTRIES)[ring->cq_head &
+                                              (RING_ENTRIES - 1)].res < 0)
+                return -1;
+            ring->cq_head++;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int start;
+    int print_ticks, print_ring_ticks, pages_ticks, pages_ring_ticks;
+    int i;
+
+    if (new_pages(RING_BASE, (RING_SIZE(RING_ENTRIES) + PAGE_SIZE - 1) &
+                             ~(PAGE_SIZE - 1)) < 0 ||
+        ring_setup(ring, RING_ENTRIES) < 0) {
+        printf("ring_bench: could not set up the ring\n");
+        return -1;
+    }
+
+    start = get_ticks();
+    for (i = 0; i < ROUNDS; i++)
+        print(1, &dot);
+    print_ticks = get_ticks() - start;
+
+    start = get_ticks();
+    for (i = 0; i < ROUNDS; i++)
+        if (submit(SYS_PRINT, (int)&print_args) < 0)
+            break;
+    if (i < ROUNDS || drain() < 0) {
+        printf("\nring_bench: ring print failed\n");
+        return -1;
+    }
+    print_ring_ticks = get_ticks() - start;
+
+    start = get_ticks();
+    for (i = 0; i < ROUNDS; i++) {
+        if (new_pages(PAGE_BASE, PAGE_SIZE) < 0 ||
+            remove_pages(PAGE_BASE) < 0)
+            break;
+    }
+    if (i < ROUNDS) {
+        printf("\nring_bench: new_pages failed\n");
+        return -1;
+    }
+    pages_ticks = get_ticks() - start;
+
+    start = get_ticks();
+    for (i = 0; i < ROUNDS; i++) {
+        if (submit(SYS_NEW_PAGES, (int)&new_pages_args) < 0 ||
+            submit(SYS_REMOVE_PAGES, (int)PAGE_BASE) < 0)
+            break;
+    }
+    if (i < ROUNDS || drain() < 0) {
+        printf("\nring_bench: ring new_pages failed\n");
+        return -1;
+    }
+    pages_ring_ticks = get_ticks() - start;
+
+    printf("\nring_bench: %d prints: %d ticks, %d ticks through the ring\n",
+           ROUNDS, print_ticks, print_ring_ticks);
+    printf("ring_bench: %d page pairs: %d ticks, %d ticks through the ring\n",
+           ROUNDS, pages_ticks, pages_ring_ticks);
+
+    return 0;
+}
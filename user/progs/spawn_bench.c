@@ -0,0 +1,102 @@
+/** @file user/progs/spawn_bench.c
+ *
+ *  @brief compare fork followed by exec with spawn, from a big parent
+ *
+ *  The parent maps 64 MB first, so every fork has that much to share
+ *  copy-on-write. Each round starts this very program with the argument
+ *  "child", which exits right away, and waits for it.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <syscall_ext.h>
+#include <stdio.h>
+#include <string.h>
+
+/* the size of the parent */
+#define BIG_LEN (64 * 1024 * 1024)
+
+/* somewhere above the program image */
+#define BIG_BASE ((void *)0x10000000)
+
+/* the number of children started each way */
+#define ROUNDS 200
+
+static char *child_argv[] = { "spawn_bench", "child", NULL };
+
+/** @brief start ROUNDS children by fork and exec
+ *
+ *  @return the ticks it took, -1 on error
+ */
+static int run_fork_exec(void)
+{
+    unsigned int start = get_ticks();
+    int i, pid, status;
+
+    for (i = 0; i < ROUNDS; i++) {
+        if ((pid = fork()) < 0)
+            return -1;
+
+        if (pid == 0) {
+            exec(child_argv[0], child_argv);
+            vanish();
+        }
+
+        if (wait(&status) != pid)
+            return -1;
+    }
+
+    return get_ticks() - start;
+}
+
+/** @brief start ROUNDS children by spawn
+ *
+ *  @return the ticks it took, -1 on error
+ */
+static int run_spawn(void)
+{
+    unsigned int start = get_ticks();
+    int i, pid, status;
+
+    for (i = 0; i < ROUNDS; i++) {
+        if ((pid = spawn(child_argv[0], child_argv)) < 0)
+            return -1;
+
+        if (wait(&status) != pid)
+            return -1;
+    }
+
+    return get_ticks() - start;
+}
+
+int main(int argc, char **argv)
+{
+    int fork_ticks, spawn_ticks;
+
+    if (argc > 1 && strcmp(argv[1], "child") == 0)
+        return 0;
+
+    if (new_pages(BIG_BASE, BIG_LEN) < 0) {
+        printf("spawn_bench: could not map %d MB\n", BIG_LEN >> 20);
+        return -1;
+    }
+
+    if ((fork_ticks = run_fork_exec()) < 0) {
+        printf("spawn_bench: fork and exec failed\n");
+        return -1;
+    }
+
+    if ((spawn_ticks = run_spawn()) < 0) {
+        printf("spawn_bench: spawn failed\n");
+        return -1;
+    }
+
+    printf("spawn_bench: %d children from a %d MB parent\n", ROUNDS,
+           BIG_LEN >> 20);
+    printf("spawn_bench: fork + exec %d ticks, spawn %d ticks\n",
+           fork_ticks, spawn_ticks);
+
+    return 0;
+}
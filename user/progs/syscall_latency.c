@@ -0,0 +1,97 @@
+/** @file user/progs/syscall_latency.c
+ *
+ *  @brief compare the int trap path, the SYSENTER path and the vdso page
+ *
+ *  gettid does next to nothing in the kernel, so its cost is about the
+ *  cost of getting in and out. It is made by trapping to GETTID_INT, and
+ *  through sysenter_call, directly. The library gettid reads the vdso
+ *  page and does not enter the kernel at all.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <syscall_int.h>
+#include <syscall_ext.h>
+#include <stdio.h>
+
+/* the number of calls timed each way */
+#define ROUNDS 100000
+
+/** @brief read the time stamp counter
+ *
+ *  @return the cycles since reset
+ */
+static unsigned long long rdtsc(void)
+{
+    unsigned long long tsc;
+
+    asm volatile ("rdtsc" : "=A" (tsc));
+    return tsc;
+}
+
+/** @brief gettid through the int trap gate
+ *
+ *  @return the tid
+ */
+static int int_gettid(void)
+{
+    int tid;
+
+    asm volatile ("int %1" : "=a" (tid) : "i" (GETTID_INT) : "memory");
+    return tid;
+}
+
+/** @brief gettid through SYSENTER
+ *
+ *  @return the tid
+ */
+static int sysenter_gettid(void)
+{
+    int tid;
+
+    asm volatile ("call sysenter_call" : "=a" (tid) : "a" (SYS_GETTID)
+                  : "ecx", "edx", "memory");
+    return tid;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long long start, int_cycles, sysenter_cycles, vdso_cycles;
+    vdso_data_t *vdso = (vdso_data_t *)VDSO_ADDR;
+    int i;
+
+    /* fault the stubs in first */
+    int_gettid();
+    sysenter_gettid();
+    gettid();
+
+    start = rdtsc();
+    for (i = 0; i < ROUNDS; i++)
+        int_gettid();
+    int_cycles = rdtsc() - start;
+
+    start = rdtsc();
+    for (i = 0; i < ROUNDS; i++)
+        sysenter_gettid();
+    sysenter_cycles = rdtsc() - start;
+
+    start = rdtsc();
+    for (i = 0; i < ROUNDS; i++)
+        gettid();
+    vdso_cycles = rdtsc() - start;
+
+    printf("syscall_latency: %d calls each way\n", ROUNDS);
+    printf("syscall_latency: int %d, sysenter %d, vdso %d cycles per call\n",
+           (int)(int_cycles / ROUNDS), (int)(sysenter_cycles / ROUNDS),
+           (int)(vdso_cycles / ROUNDS));
+
+    /* the kernel calibrates the counter against the timer */
+    if (vdso->tsc_per_tick != 0)
+        printf("syscall_latency: int %d ns per call\n",
+               (int)(int_cycles * vdso->usecs_per_tick * 1000 /
+                     vdso->tsc_per_tick / ROUNDS));
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/** @file user/progs/sysstat.c
+ *
+ *  @brief print the syscall statistics table
+ *
+ *  sysstat prints the table of the whole system, sysstat <pid> the one of
+ *  a process: for every syscall made, the calls, the failed calls, the
+ *  average and the largest TSC cycles per call, then the latency
+ *  histogram as "<log2 cycles>:<calls>" pairs.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <syscall_ext.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* the names by SYS_ number */
+static const char *names[SYSENTER_NSYS] = {
+    [SYS_EXEC] = "exec",
+    [SYS_WAIT] = "wait",
+    [SYS_YIELD] = "yield",
+    [SYS_DESCHEDULE] = "deschedule",
+    [SYS_MAKE_RUNNABLE] = "make_runnable",
+    [SYS_GETTID] = "gettid",
+    [SYS_NEW_PAGES] = "new_pages",
+    [SYS_REMOVE_PAGES] = "remove_pages",
+    [SYS_SLEEP] = "sleep",
+    [SYS_GETCHAR] = "getchar",
+    [SYS_READLINE] = "readline",
+    [SYS_PRINT] = "print",
+    [SYS_SET_TERM_COLOR] = "set_term_color",
+    [SYS_SET_CURSOR_POS] = "set_cursor_pos",
+    [SYS_GET_CURSOR_POS] = "get_cursor_pos",
+    [SYS_GET_TICKS] = "get_ticks",
+    [SYS_MISBEHAVE] = "misbehave",
+    [SYS_HALT] = "halt",
+    [SYS_TASK_VANISH] = "task_vanish",
+    [SYS_SET_STATUS] = "set_status",
+    [SYS_VANISH] = "vanish",
+    [SYS_READFILE] = "readfile",
+    [SYS_SWEXN] = "swexn",
+    [SYS_SET_MEM_LIMIT] = "set_mem_limit",
+    [SYS_GET_MEM_USAGE] = "get_mem_usage",
+    [SYS_STACK_REGION] = "stack_region",
+    [SYS_SPAWN] = "spawn",
+    [SYS_TEMPLATE_SPAWN] = "template_spawn",
+    [SYS_TEMPLATE_DROP] = "template_drop",
+    [SYS_RING_SETUP] = "ring_setup",
+    [SYS_RING_ENTER] = "ring_enter",
+    [SYS_FUTEX_WAIT] = "futex_wait",
+    [SYS_FUTEX_WAKE] = "futex_wake",
+    [SYS_SYSCALL_STATS] = "syscall_stats",
+    [SYS_CONSOLE_MODE] = "console_mode",
+    [SYS_SET_VTERM] = "set_vterm",
+    [SYS_BLIT_CELLS] = "blit_cells",
+    [SYS_CONSOLE_MAP] = "console_map",
+    [SYS_POLL] = "poll",
+    [SYS_PRINT_FLUSH] = "print_flush",
+};
+
+static syscall_stat_t stats[SYSENTER_NSYS];
+
+int main(int argc, char **argv)
+{
+    int pid = 0;
+    int n, i, b;
+
+    if (argc > 1)
+        pid = atoi(argv[1]);
+
+    if ((n = syscall_stats(pid, stats, SYSENTER_NSYS)) < 0) {
+        printf("sysstat: no statistics for %s %d\n",
+               pid ? "process" : "system", pid);
+        return -1;
+    }
+
+    printf("%-16s %8s %8s %10s %12s\n", "syscall", "calls", "errors",
+           "avg cyc", "max cyc");
+
+    for (i = 0; i < n; i++) {
+        syscall_stat_t *s = &stats[i];
+
+        if (s->calls == 0)
+            continue;
+
+        printf("%-16s %8u %8u %10u %12u\n",
+               names[i] != NULL ? names[i] : "?", s->calls, s->errors,
+               (unsigned)(s->total_cycles / s->calls),
+               (unsigned)s->max_cycles);
+
+        printf("%16s", "");
+        for (b = 0; b < SYSCALL_STAT_BUCKETS; b++) {
+            if (s->hist[b] != 0)
+                printf(" %d:%u", b, s->hist[b]);
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
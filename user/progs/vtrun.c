@@ -0,0 +1,40 @@
+/** @file user/progs/vtrun.c
+ *
+ *  @brief run a program on another virtual terminal
+ *
+ *  vtrun <terminal> <program> [args...] moves itself to the terminal and
+ *  execs the program there, e.g. "vtrun 1 shell" puts a shell on Alt+F2.
+ *  Background workers started this way print without getting in the way
+ *  of the shell on the screen.
+ *
+ *  @author Hingon Miu (hmiu@andrew.cmu.edu)
+ *  @author An Wu (anwu@andrew.cmu.edu)
+ */
+
+#include <syscall.h>
+#include <syscall_ext.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+    int vt;
+
+    if (argc < 3) {
+        printf("usage: vtrun <terminal 0-%d> <program> [args...]\n",
+               NVTERMS - 1);
+        return -1;
+    }
+
+    vt = atoi(argv[1]);
+    if (set_vterm(vt) < 0) {
+        printf("vtrun: no terminal %d\n", vt);
+        return -1;
+    }
+
+    exec(argv[2], &argv[2]);
+
+    /* still here, tell the terminal it was meant for */
+    printf("vtrun: can't exec %s\n", argv[2]);
+    return -1;
+}